@@ -29,6 +29,7 @@
 #include <cstring>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 namespace CMSat {
 using std::vector;
@@ -123,6 +124,50 @@ public:
     }
 };
 
+/**
+@brief Exponential moving average
+
+Until 1/alpha elements have been pushed, the plain average is calculated, so
+the start-up value of 0 does not bias slow averages
+*/
+class EMA {
+    double  value;
+    double  alpha;
+    double  beta;
+    size_t  num;
+
+public:
+    EMA(const double _alpha = 1.0) :
+        value(0)
+        , alpha(_alpha)
+        , beta(1.0)
+        , num(0)
+    {}
+
+    void push(const double x)
+    {
+        num++;
+        beta = std::max(alpha, 1.0/(double)num);
+        value += beta*(x - value);
+    }
+
+    double avg() const
+    {
+        return value;
+    }
+
+    size_t getNum() const
+    {
+        return num;
+    }
+
+    void clear()
+    {
+        EMA tmp(alpha);
+        *this = tmp;
+    }
+};
+
 } //end namespace
 
 #endif //__AVGCALC_H__
@@ -0,0 +1,208 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "backbone.h"
+#include "solver.h"
+#include "varreplacer.h"
+#include "prober.h"
+#include "time_mem.h"
+#include <algorithm>
+
+using namespace CMSat;
+
+Backbone::Backbone(Solver* _solver) :
+    solver(_solver)
+    , startTime(0)
+    , lastPrint(0)
+{
+}
+
+lbool Backbone::extract()
+{
+    //Assumptions on eliminated or decomposed variables are not honoured, and
+    //blocked clause elimination does not preserve the models
+    release_assert(!solver->conf.doVarElim
+        && !solver->conf.doCompHandler
+        && !solver->conf.doBlockClauses
+    );
+
+    startTime = cpuTime();
+    lastPrint = startTime;
+
+    //The literals of the first model are the candidates
+    vector<Lit> assumps;
+    lbool ret = solver->solve(&assumps);
+    stats.numSolveCalls++;
+    stats.solveTime += cpuTime() - startTime;
+    if (ret != l_True)
+        return ret;
+
+    stats.numSat++;
+    for(size_t var = 0; var < solver->nVarsOutside(); var++) {
+        if (solver->model[var] != l_Undef) {
+            cands.push_back(Lit(var, solver->model[var] == l_False));
+        }
+    }
+    stats.numCands = cands.size();
+
+    //Cheap ones first
+    stats.fixedZeroLev += checkZeroLevel();
+    if (solver->conf.doProbe && !probeCands())
+        return l_False;
+
+    //The simplifications would re-run at the start of every call
+    solver->conf.doPreSchedSimpProblem = false;
+
+    //Test the rest one by one, keeping the learnt clauses
+    assumps.resize(1);
+    while(!cands.empty()) {
+        const Lit lit = cands.back();
+        assumps[0] = ~lit;
+        const double myTime = cpuTime();
+        ret = solver->solve(&assumps);
+        stats.numSolveCalls++;
+        stats.solveTime += cpuTime() - myTime;
+
+        if (ret == l_Undef) {
+            printProgress(true);
+            return l_Undef;
+        }
+
+        if (ret == l_True) {
+            stats.numSat++;
+            release_assert(solver->modelValue(lit) == l_False);
+            filterByModel();
+        } else {
+            if (!solver->ok)
+                return l_False;
+
+            cands.pop_back();
+            backbone.push_back(lit);
+            stats.fixedSolve++;
+
+            //The unit may fix others through propagation
+            vector<Lit> unit(1, lit);
+            if (!solver->addClause(unit))
+                return l_False;
+            stats.fixedZeroLev += checkZeroLevel();
+        }
+        printProgress(false);
+    }
+    printProgress(true);
+
+    std::sort(backbone.begin(), backbone.end());
+    return l_True;
+}
+
+Lit Backbone::outsideToInter(const Lit lit) const
+{
+    const Var outer = solver->outsideToOuterMain[lit.var()];
+    const Lit inter(solver->outerToInterMain[outer], lit.sign());
+    return solver->varReplacer->getLitReplacedWith(inter);
+}
+
+/**
+@brief Moves the candidates that are set at decision level 0 into the backbone
+
+@returns the number of candidates moved
+*/
+uint64_t Backbone::checkZeroLevel()
+{
+    assert(solver->decisionLevel() == 0);
+
+    uint64_t fixed = 0;
+    size_t j = 0;
+    for(size_t i = 0; i < cands.size(); i++) {
+        const Lit lit = cands[i];
+        const lbool val = solver->value(outsideToInter(lit));
+
+        //Every model so far satisfied it
+        assert(val != l_False);
+        if (val == l_True) {
+            backbone.push_back(lit);
+            fixed++;
+        } else {
+            cands[j++] = lit;
+        }
+    }
+    cands.resize(j);
+
+    return fixed;
+}
+
+/**
+@brief Probes the candidate variables
+
+Failed literals and literals implied by both polarities of a candidate are set
+at decision level 0 by the Prober. The budget is that of one probing round.
+*/
+bool Backbone::probeCands()
+{
+    vector<Var> vars;
+    for(size_t i = 0; i < cands.size(); i++) {
+        vars.push_back(outsideToInter(cands[i]).var());
+    }
+
+    const double myTime = cpuTime();
+    const bool ret = solver->prober->probe(&vars);
+    stats.probeTime += cpuTime() - myTime;
+    if (!ret)
+        return false;
+
+    stats.fixedProbe += checkZeroLevel();
+    return true;
+}
+
+void Backbone::filterByModel()
+{
+    size_t j = 0;
+    for(size_t i = 0; i < cands.size(); i++) {
+        const Lit lit = cands[i];
+        if (solver->modelValue(lit) == l_True) {
+            cands[j++] = lit;
+        } else {
+            stats.filteredModel++;
+        }
+    }
+    cands.resize(j);
+}
+
+void Backbone::printProgress(const bool force)
+{
+    const double now = cpuTime();
+    if (solver->conf.verbosity < 1
+        || (!force && now - lastPrint < 2.0)
+    ) {
+        return;
+    }
+    lastPrint = now;
+
+    cout
+    << "c [backbone]"
+    << " backbone: " << backbone.size()
+    << " cands left: " << cands.size()
+    << " filtered: " << stats.filteredModel
+    << " SAT calls: " << stats.numSolveCalls
+    << " cands/s: " << std::fixed << std::setprecision(1)
+    << (double)(stats.numCands - cands.size())/(now - startTime)
+    << " T: " << std::setprecision(2) << (now - startTime) << " s"
+    << endl;
+}
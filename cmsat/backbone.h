@@ -0,0 +1,176 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __BACKBONE_H__
+#define __BACKBONE_H__
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+class Solver;
+using std::vector;
+using std::cout;
+using std::endl;
+
+/**
+@brief Computes the backbone: the literals that are TRUE in every model
+
+Built on the incremental Solver::solve() with assumptions. The literals of the
+first model are the candidates. Many are fixed without a SAT call:
+the ones set at decision level 0, and the ones that the Prober's failed
+literal probing and both-propagation set at level 0 when restricted to the
+candidate variables. Every model found afterwards removes the candidates it
+falsifies. The rest are tested one by one by assuming their negation: if that
+is UNSAT the literal is in the backbone and is added as a unit clause (which
+may in turn fix others through propagation), otherwise the new model filters
+the candidates. Learnt clauses are kept between the calls.
+
+Variable elimination and component handling must be switched off by the
+caller, since assumptions on removed variables are not honoured. So must
+blocked clause elimination, since the models it extends may differ from the
+models of the simplified problem.
+*/
+class Backbone
+{
+    public:
+        Backbone(Solver* solver);
+
+        //Returns l_True if the full backbone was found, l_False if the
+        //problem is UNSAT, l_Undef if interrupted or over the limits
+        lbool extract();
+
+        //In outside numbering, ordered by variable
+        const vector<Lit>& getBackbone() const;
+
+        struct Stats
+        {
+            Stats() :
+                numCands(0)
+                , fixedZeroLev(0)
+                , fixedProbe(0)
+                , fixedSolve(0)
+                , filteredModel(0)
+                , numSolveCalls(0)
+                , numSat(0)
+                , probeTime(0)
+                , solveTime(0)
+            {}
+
+            double totalTime() const
+            {
+                return probeTime + solveTime;
+            }
+
+            uint64_t numFixed() const
+            {
+                return fixedZeroLev + fixedProbe + fixedSolve;
+            }
+
+            void print() const
+            {
+                cout << "c -------- BACKBONE STATS --------" << endl;
+                printStatsLine("c time"
+                    , totalTime()
+                    , (double)numCands/totalTime()
+                    , "cands/s"
+                );
+                printStatsLine("c candidates"
+                    , numCands
+                );
+                printStatsLine("c backbone size"
+                    , numFixed()
+                    , (double)numFixed()/(double)numCands*100.0
+                    , "% of cands"
+                );
+                printStatsLine("c fixed at level 0"
+                    , fixedZeroLev
+                );
+                printStatsLine("c fixed by probing"
+                    , fixedProbe
+                    , probeTime
+                    , "s"
+                );
+                printStatsLine("c fixed by SAT calls"
+                    , fixedSolve
+                );
+                printStatsLine("c filtered by models"
+                    , filteredModel
+                );
+                printStatsLine("c SAT calls"
+                    , numSolveCalls
+                    , (double)numSat/(double)numSolveCalls*100.0
+                    , "% SAT"
+                );
+                printStatsLine("c SAT call time"
+                    , solveTime
+                    , solveTime/(double)numSolveCalls
+                    , "s per call"
+                );
+                cout << "c -------- BACKBONE STATS END --------" << endl;
+            }
+
+            uint64_t numCands;
+            uint64_t fixedZeroLev;
+            uint64_t fixedProbe;
+            uint64_t fixedSolve;
+            uint64_t filteredModel;
+            uint64_t numSolveCalls;
+            uint64_t numSat;
+            double probeTime;
+            double solveTime;
+        };
+
+        const Stats& getStats() const;
+
+    private:
+        Solver* solver;
+
+        Lit outsideToInter(const Lit lit) const;
+        uint64_t checkZeroLevel();
+        bool probeCands();
+        void filterByModel();
+        void printProgress(const bool force);
+
+        vector<Lit> cands; ///<Not yet decided, outside numbering
+        vector<Lit> backbone;
+        double startTime;
+        double lastPrint;
+
+        Stats stats;
+};
+
+inline const vector<Lit>& Backbone::getBackbone() const
+{
+    return backbone;
+}
+
+inline const Backbone::Stats& Backbone::getStats() const
+{
+    return stats;
+}
+
+} //end namespace
+
+#endif //__BACKBONE_H__
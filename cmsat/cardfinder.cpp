@@ -0,0 +1,415 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "cardfinder.h"
+#include "solver.h"
+#include "time_mem.h"
+#include <algorithm>
+#include <functional>
+
+using namespace CMSat;
+
+CardFinder::CardFinder(Solver* _solver) :
+    solver(_solver)
+    , numMaxFind(0)
+    , binsRemoved(false)
+{
+}
+
+/**
+@brief Number of irredundant binaries (~lit V ~other), i.e. the number of
+literals that can't be TRUE together with 'lit'
+*/
+size_t CardFinder::degree(const Lit lit)
+{
+    const vec<Watched>& ws = solver->watches[(~lit).toInt()];
+    size_t num = 0;
+    for(vec<Watched>::const_iterator
+        it = ws.begin(), end = ws.end()
+        ; it != end && it->isBinary()
+        ; it++
+    ) {
+        num += !it->learnt();
+    }
+    numMaxFind -= ws.size()/4 + 1;
+
+    return num;
+}
+
+void CardFinder::find()
+{
+    assert(solver->ok);
+    assert(solver->decisionLevel() == 0);
+    assert(solver->qhead == solver->trail.size());
+    assert(solver->getNumCards() == 0);
+
+    const double myTime = cpuTime();
+    const size_t minSize = solver->conf.cardMinSize;
+    numMaxFind = solver->conf.cardFindLimitM*1000LL*1000LL;
+    runStats.numCalls = 1;
+
+    //Most connected literals first
+    seeds.clear();
+    for(size_t i = 0; i < solver->nVars()*2; i++) {
+        const Lit lit = Lit::toLit(i);
+        if (solver->value(lit) != l_Undef)
+            continue;
+
+        const size_t deg = degree(lit);
+        if (deg + 1 >= minSize) {
+            seeds.push_back(std::make_pair(deg, lit));
+        }
+    }
+    std::sort(seeds.begin(), seeds.end()
+        , std::greater<std::pair<size_t, Lit> >());
+
+    for(vector<std::pair<size_t, Lit> >::const_iterator
+        it = seeds.begin(), end = seeds.end()
+        ; it != end
+        ; it++
+    ) {
+        //A literal can be part of more than one constraint
+        while(numMaxFind > 0
+            && degree(it->second) + 1 >= minSize
+        ) {
+            findClique(it->second);
+            if (clique.size() < minSize)
+                break;
+
+            addCard();
+        }
+
+        if (numMaxFind <= 0) {
+            runStats.findTimeOut++;
+            break;
+        }
+    }
+    setupOccs();
+
+    //The constraints are only used on top of the binaries
+    if (!solver->conf.doCardRemBins && binsRemoved) {
+        addBackBins();
+        binsRemoved = false;
+    }
+
+    runStats.findTime = cpuTime() - myTime;
+    if (solver->conf.verbosity >= 2
+        || (solver->conf.verbosity >= 1 && runStats.numCards > 0)
+    ) {
+        runStats.printShort();
+    }
+    globalStats += runStats;
+    runStats.clear();
+}
+
+/**
+@brief Greedily grows a clique of mutually exclusive literals from 'seed'
+
+'cands' are the literals that are exclusive with all of the clique. The one
+exclusive with most of the other candidates is added next, until none remain.
+*/
+void CardFinder::findClique(const Lit seed)
+{
+    vector<uint16_t>& seen = solver->seen;
+    clique.clear();
+    clique.push_back(seed);
+
+    cands.clear();
+    const vec<Watched>& ws = solver->watches[(~seed).toInt()];
+    for(vec<Watched>::const_iterator
+        it = ws.begin(), end = ws.end()
+        ; it != end && it->isBinary()
+        ; it++
+    ) {
+        const Lit lit = ~it->lit2();
+        if (it->learnt()
+            || seen[lit.toInt()]
+            || solver->value(lit) != l_Undef
+        ) {
+            continue;
+        }
+
+        seen[lit.toInt()] = 1;
+        cands.push_back(lit);
+    }
+    for(vector<Lit>::const_iterator
+        it = cands.begin(), end = cands.end()
+        ; it != end
+        ; it++
+    ) {
+        seen[it->toInt()] = 0;
+    }
+    numMaxFind -= ws.size();
+
+    while(!cands.empty() && numMaxFind > 0) {
+        for(vector<Lit>::const_iterator
+            it = cands.begin(), end = cands.end()
+            ; it != end
+            ; it++
+        ) {
+            seen[it->toInt()] = 1;
+        }
+
+        //Candidate connected to most of the others
+        size_t best = 0;
+        size_t bestNum = 0;
+        bool allConnected = true;
+        for(size_t i = 0; i < cands.size(); i++) {
+            const vec<Watched>& ws2 = solver->watches[(~cands[i]).toInt()];
+            //Duplicate binaries must not be counted twice
+            size_t num = 0;
+            for(vec<Watched>::const_iterator
+                it = ws2.begin(), end = ws2.end()
+                ; it != end && it->isBinary()
+                ; it++
+            ) {
+                uint16_t& mark = seen[(~it->lit2()).toInt()];
+                if (!it->learnt() && mark == 1) {
+                    num++;
+                    mark = 2;
+                }
+            }
+            for(vec<Watched>::const_iterator
+                it = ws2.begin(), end = ws2.end()
+                ; it != end && it->isBinary()
+                ; it++
+            ) {
+                uint16_t& mark = seen[(~it->lit2()).toInt()];
+                if (mark == 2) {
+                    mark = 1;
+                }
+            }
+            numMaxFind -= ws2.size()*2;
+
+            allConnected &= (num + 1 >= cands.size());
+            if (num > bestNum || i == 0) {
+                best = i;
+                bestNum = num;
+            }
+        }
+
+        for(vector<Lit>::const_iterator
+            it = cands.begin(), end = cands.end()
+            ; it != end
+            ; it++
+        ) {
+            seen[it->toInt()] = 0;
+        }
+
+        //The rest form a clique, too
+        if (allConnected) {
+            clique.insert(clique.end(), cands.begin(), cands.end());
+            break;
+        }
+
+        //Keep the candidates that are exclusive with the new member
+        const Lit lit = cands[best];
+        clique.push_back(lit);
+        const vec<Watched>& ws3 = solver->watches[(~lit).toInt()];
+        for(vec<Watched>::const_iterator
+            it = ws3.begin(), end = ws3.end()
+            ; it != end && it->isBinary()
+            ; it++
+        ) {
+            if (!it->learnt()) {
+                seen[(~it->lit2()).toInt()] = 1;
+            }
+        }
+        size_t j = 0;
+        for(size_t i = 0; i < cands.size(); i++) {
+            if (cands[i] != lit && seen[cands[i].toInt()]) {
+                cands[j++] = cands[i];
+            }
+        }
+        cands.resize(j);
+        for(vec<Watched>::const_iterator
+            it = ws3.begin(), end = ws3.end()
+            ; it != end && it->isBinary()
+            ; it++
+        ) {
+            seen[(~it->lit2()).toInt()] = 0;
+        }
+        numMaxFind -= ws3.size();
+    }
+}
+
+/**
+@brief Removes the binaries between the members of 'clique', and stores it
+as a constraint
+*/
+void CardFinder::addCard()
+{
+    vector<uint16_t>& seen = solver->seen;
+    for(vector<Lit>::const_iterator
+        it = clique.begin(), end = clique.end()
+        ; it != end
+        ; it++
+    ) {
+        seen[it->toInt()] = 1;
+    }
+
+    size_t irredRemoved = 0;
+    size_t redRemoved = 0;
+    for(vector<Lit>::const_iterator
+        it = clique.begin(), end = clique.end()
+        ; it != end
+        ; it++
+    ) {
+        vec<Watched>& ws = solver->watches[(~*it).toInt()];
+        vec<Watched>::iterator i = ws.begin();
+        vec<Watched>::iterator j = ws.begin();
+        for(vec<Watched>::iterator end2 = ws.end(); i != end2; i++) {
+            if (i->isBinary() && seen[(~i->lit2()).toInt()]) {
+                if (i->learnt())
+                    redRemoved++;
+                else
+                    irredRemoved++;
+
+                continue;
+            }
+            *j++ = *i;
+        }
+        ws.shrink_(i-j);
+        numMaxFind -= ws.size();
+    }
+
+    for(vector<Lit>::const_iterator
+        it = clique.begin(), end = clique.end()
+        ; it != end
+        ; it++
+    ) {
+        seen[it->toInt()] = 0;
+    }
+
+    //Every binary was in two watchlists
+    assert(irredRemoved % 2 == 0 && redRemoved % 2 == 0);
+    solver->binTri.irredBins -= irredRemoved/2;
+    solver->binTri.irredLits -= irredRemoved;
+    solver->binTri.redBins -= redRemoved/2;
+    solver->binTri.redLits -= redRemoved;
+    runStats.irredBinsRemoved += irredRemoved/2;
+    runStats.redBinsRemoved += redRemoved/2;
+    binsRemoved = true;
+
+    //Store the constraint
+    if (solver->cardStart.empty()) {
+        solver->cardStart.push_back(0);
+    }
+    solver->cardLits.insert(solver->cardLits.end(), clique.begin(), clique.end());
+    solver->cardStart.push_back(solver->cardLits.size());
+    runStats.numCards++;
+    runStats.numCardLits += clique.size();
+}
+
+void CardFinder::setupOccs()
+{
+    if (solver->getNumCards() == 0)
+        return;
+
+    vector<uint32_t>& occStart = solver->cardOccStart;
+    occStart.clear();
+    occStart.resize(solver->nVars()*2+1, 0);
+    for(vector<Lit>::const_iterator
+        it = solver->cardLits.begin(), end = solver->cardLits.end()
+        ; it != end
+        ; it++
+    ) {
+        occStart[it->toInt()+1]++;
+    }
+    for(size_t i = 1; i < occStart.size(); i++) {
+        occStart[i] += occStart[i-1];
+    }
+
+    vector<uint32_t>& occs = solver->cardOccs;
+    occs.resize(solver->cardLits.size());
+    vector<uint32_t> at(occStart.begin(), occStart.end()-1);
+    for(size_t card = 0; card < solver->getNumCards(); card++) {
+        for(uint32_t i = solver->cardStart[card]; i < solver->cardStart[card+1]; i++) {
+            occs[at[solver->cardLits[i].toInt()]++] = card;
+        }
+    }
+}
+
+/**
+@brief Adds back the binaries of all constraints
+
+Level 0 is fully propagated, so a binary with an assigned literal is
+satisfied, and is not needed anymore
+*/
+void CardFinder::addBackBins()
+{
+    const size_t origNewBins = solver->binTri.numNewBinsSinceSCC;
+    for(size_t card = 0; card < solver->getNumCards(); card++) {
+        const Lit* lits = &solver->cardLits[solver->cardStart[card]];
+        const size_t size = solver->cardStart[card+1] - solver->cardStart[card];
+        for(size_t i = 0; i < size; i++) {
+            if (solver->value(lits[i]) != l_Undef)
+                continue;
+
+            for(size_t i2 = i+1; i2 < size; i2++) {
+                if (solver->value(lits[i2]) != l_Undef)
+                    continue;
+
+                solver->attachBinClause(~lits[i], ~lits[i2], false, false);
+            }
+        }
+    }
+
+    //These are not new
+    solver->binTri.numNewBinsSinceSCC = origNewBins;
+}
+
+bool CardFinder::restoreBins()
+{
+    if (solver->getNumCards() == 0)
+        return solver->ok;
+
+    assert(solver->decisionLevel() == 0);
+    if (solver->ok && solver->qhead != solver->trail.size()) {
+        solver->ok = solver->propagate().isNULL();
+    }
+
+    if (solver->ok && binsRemoved) {
+        addBackBins();
+    }
+    binsRemoved = false;
+
+    solver->cardLits.clear();
+    solver->cardStart.clear();
+    solver->cardOccStart.clear();
+    solver->cardOccs.clear();
+
+    return solver->ok;
+}
+
+uint64_t CardFinder::memUsed() const
+{
+    uint64_t mem = 0;
+    mem += seeds.capacity()*sizeof(std::pair<size_t, Lit>);
+    mem += clique.capacity()*sizeof(Lit);
+    mem += cands.capacity()*sizeof(Lit);
+    mem += solver->cardLits.capacity()*sizeof(Lit);
+    mem += solver->cardStart.capacity()*sizeof(uint32_t);
+    mem += solver->cardOccStart.capacity()*sizeof(uint32_t);
+    mem += solver->cardOccs.capacity()*sizeof(uint32_t);
+
+    return mem;
+}
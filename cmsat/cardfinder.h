@@ -0,0 +1,178 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __CARDFINDER_H__
+#define __CARDFINDER_H__
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+class Solver;
+using std::vector;
+using std::cout;
+using std::endl;
+
+/**
+@brief Finds at-most-one constraints encoded as pairwise binary clauses
+
+An at-most-one constraint over lits a_1...a_n is the clique of irredundant
+binary clauses (~a_i V ~a_j). The cliques are grown greedily from the literals
+with the most binaries, always adding the candidate that is connected to most
+of the remaining candidates. Sequential counter encodings are found through
+this as well, once variable elimination has removed the counter variables.
+
+The constraints found are handed to PropEngine, which propagates them
+natively, and (if conf.doCardRemBins is set) the binaries are removed from
+the watchlists. The native constraints only exist during search: everything
+else (simplification, component handling, solution checking) works on plain
+clauses, so restoreBins() must be called once the search is over.
+*/
+class CardFinder
+{
+    public:
+        CardFinder(Solver* solver);
+
+        //Must be called at decision level 0, after propagation
+        void find();
+
+        //Turn the constraints back into binary clauses. Returns solver->ok
+        bool restoreBins();
+
+        uint64_t memUsed() const;
+
+        struct Stats
+        {
+            Stats() :
+                numCalls(0)
+                , numCards(0)
+                , numCardLits(0)
+                , irredBinsRemoved(0)
+                , redBinsRemoved(0)
+                , findTime(0)
+                , findTimeOut(0)
+            {}
+
+            void clear()
+            {
+                Stats tmp;
+                *this = tmp;
+            }
+
+            Stats& operator+=(const Stats& other)
+            {
+                numCalls += other.numCalls;
+                numCards += other.numCards;
+                numCardLits += other.numCardLits;
+                irredBinsRemoved += other.irredBinsRemoved;
+                redBinsRemoved += other.redBinsRemoved;
+                findTime += other.findTime;
+                findTimeOut += other.findTimeOut;
+
+                return *this;
+            }
+
+            void print() const
+            {
+                cout << "c -------- CARDINALITY STATS --------" << endl;
+                printStatsLine("c at-most-one found"
+                    , numCards
+                    , (double)numCardLits/(double)numCards
+                    , "avg size"
+                );
+                printStatsLine("c irred bins removed"
+                    , irredBinsRemoved
+                    , (double)irredBinsRemoved/(double)numCalls
+                    , "per call"
+                );
+                printStatsLine("c red bins removed"
+                    , redBinsRemoved
+                );
+                printStatsLine("c find time"
+                    , findTime
+                    , findTime/(double)numCalls
+                    , "per call"
+                );
+                printStatsLine("c timeouts"
+                    , findTimeOut
+                    , (double)findTimeOut/(double)numCalls*100.0
+                    , "% of calls"
+                );
+                cout << "c -------- CARDINALITY STATS END --------" << endl;
+            }
+
+            void printShort() const
+            {
+                cout
+                << "c [card]"
+                << " found: " << numCards
+                << " avg size: " << std::fixed << std::setprecision(1)
+                << ((double)numCardLits/(double)std::max<uint64_t>(numCards, 1))
+                << " bins-rem: " << irredBinsRemoved
+                << " T: " << std::setprecision(2)
+                << findTime << " s"
+                << " T-out: " << findTimeOut
+                << endl;
+            }
+
+            uint64_t numCalls;
+            uint64_t numCards;
+            uint64_t numCardLits;
+            uint64_t irredBinsRemoved;
+            uint64_t redBinsRemoved;
+            double findTime;
+            uint64_t findTimeOut;
+        };
+
+        const Stats& getStats() const;
+
+    private:
+        Solver* solver;
+
+        //Finding
+        size_t degree(const Lit lit);
+        void findClique(const Lit seed);
+        void addCard();
+        void setupOccs();
+        vector<std::pair<size_t, Lit> > seeds;
+        vector<Lit> clique;
+        vector<Lit> cands;
+        int64_t numMaxFind;
+
+        //Restoring
+        void addBackBins();
+        bool binsRemoved;
+
+        Stats runStats;
+        Stats globalStats;
+};
+
+inline const CardFinder::Stats& CardFinder::getStats() const
+{
+    return globalStats;
+}
+
+} //end namespace
+
+#endif //__CARDFINDER_H__
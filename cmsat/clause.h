@@ -183,6 +183,7 @@ protected:
     uint16_t isFreed:1; ///<Has this clause been marked as freed by the ClauseAllocator ?
     uint16_t isAsymmed:1;
     uint16_t occurLinked:1;
+    uint16_t isDemoted:1; ///<Learnt clause has been demoted from tier2 to local
     uint16_t mySize; ///<The current size of the clause
 
 
@@ -214,6 +215,7 @@ public:
         isLearnt = false;
         isRemoved = false;
         isAsymmed = false;
+        isDemoted = false;
 
         for (uint32_t i = 0; i < ps.size(); i++)
             getData()[i] = ps[i];
@@ -371,6 +373,16 @@ public:
     {
         occurLinked = toset;
     }
+
+    void setDemoted()
+    {
+        isDemoted = true;
+    }
+
+    bool getDemoted() const
+    {
+        return isDemoted;
+    }
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Clause& cl)
@@ -542,6 +554,11 @@ struct CleaningStats
         , origNumClauses(0)
         , origNumLits(0)
 
+        //Tiers
+        , demoted(0)
+        , numKeys(0)
+        , selectTime(0)
+
         //Type of clean
         , glueBasedClean(0)
         , sizeBasedClean(0)
@@ -558,6 +575,14 @@ struct CleaningStats
         origNumClauses += other.origNumClauses;
         origNumLits += other.origNumLits;
 
+        //Tiers
+        core += other.core;
+        tier2 += other.tier2;
+        local += other.local;
+        demoted += other.demoted;
+        numKeys += other.numKeys;
+        selectTime += other.selectTime;
+
         //Type of clean
         glueBasedClean += other.glueBasedClean;
         sizeBasedClean += other.sizeBasedClean;
@@ -567,6 +592,7 @@ struct CleaningStats
         //Clause Cleaning data
         preRemove += other.preRemove;
         removed += other.removed;
+        spilled += other.spilled;
         remain += other.remain;
 
         return *this;
@@ -597,6 +623,33 @@ struct CleaningStats
             , (double)preRemove.sumResolutions()/(double)preRemove.num
         );
 
+        //Tiers
+        printStatsLine("c core cls"
+            , core.num
+            , (double)core.glue/(double)core.num
+            , "avg glue"
+        );
+        printStatsLine("c tier2 cls"
+            , tier2.num
+            , (double)tier2.glue/(double)tier2.num
+            , "avg glue"
+        );
+        printStatsLine("c local cls"
+            , local.num
+            , (double)local.glue/(double)local.num
+            , "avg glue"
+        );
+        printStatsLine("c demoted tier2 cls"
+            , demoted
+            , (double)demoted/(double)nbReduceDB
+            , "per clean"
+        );
+        printStatsLine("c clean select time"
+            , selectTime
+            , (double)numKeys/(double)nbReduceDB
+            , "keys per clean"
+        );
+
         //Types of clean
         printStatsLine("c clean by glue"
             , glueBasedClean
@@ -633,6 +686,11 @@ struct CleaningStats
         printStatsLine("c cleaned avg glue"
             , (double)removed.glue/(double)removed.num
         );
+        printStatsLine("c spilled cls"
+            , spilled.num
+            , (double)spilled.num/(double)(removed.num + preRemove.num)*100.0
+            , "% of cleaned"
+        );
 
         //--> REMAIN
         printStatsLine("c remain cls"
@@ -675,6 +733,18 @@ struct CleaningStats
         << " avgSize "
         << std::fixed << std::setprecision(2)
         << ((double)removed.lits/(double)removed.num)
+
+        << " spilled " << spilled.num
+        << endl;
+
+        cout
+        << "c [DBclean]"
+        << " core " << core.num
+        << " tier2 " << tier2.num
+        << " local " << local.num
+        << " demoted " << demoted
+        << " select T " << std::fixed << std::setprecision(2)
+        << selectTime
         << endl;
 
         cout
@@ -699,6 +769,14 @@ struct CleaningStats
     uint64_t origNumClauses;
     uint64_t origNumLits;
 
+    //Remaining learnt clauses in each tier
+    Data core;
+    Data tier2;
+    Data local;
+    uint64_t demoted; ///<Unused tier2 clauses moved to local
+    uint64_t numKeys; ///<Local clauses ranked
+    double selectTime; ///<Time to compute keys and select the worst
+
     //Clause Cleaning --pre-remove
     Data preRemove;
 
@@ -711,6 +789,7 @@ struct CleaningStats
 
     //Clause Cleaning
     Data removed;
+    Data spilled; ///<Part of preRemove+removed that went to the spill file
     Data remain;
 };
 
@@ -22,7 +22,13 @@
 #include "clauseallocator.h"
 
 #include <string.h>
+#include <stdint.h>
 #include <limits>
+#if defined(_MSC_VER) || defined(__MINGW32__)
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
 #include "assert.h"
 #include "solvertypes.h"
 #include "clause.h"
@@ -45,27 +51,79 @@ using std::endl;
 //For listing each and every clause location:
 //#define DEBUG_CLAUSEALLOCATOR2
 
-#define MIN_LIST_SIZE (50000 * (sizeof(Clause) + 4*sizeof(Lit))/sizeof(uint32_t))
-#define ALLOC_GROW_MULT 2
-//We shift stuff around in Watched, so not all of 32 bits are useable.
-#define EFFECTIVELY_USEABLE_BITS 30
-#define MAXSIZE ((1 << (EFFECTIVELY_USEABLE_BITS))-1)
+#define SLAB_BYTES ((size_t)SLAB_SIZE*sizeof(BASE_DATA_TYPE))
 
 ClauseAllocator::ClauseAllocator() :
-    dataStart(NULL)
+    peakNumSlabs(0)
     , size(0)
-    , maxSize(0)
     , currentlyUsedSize(0)
 {
-    assert(MIN_LIST_SIZE < MAXSIZE);
+    assert(sizeof(Clause) % sizeof(BASE_DATA_TYPE) == 0);
 }
 
 /**
-@brief Frees all stacks
+@brief Frees all slabs
 */
 ClauseAllocator::~ClauseAllocator()
 {
-    free(dataStart);
+    for(size_t i = 0; i < slabs.size(); i++) {
+        freeSlab(slabs[i]);
+    }
+}
+
+/**
+@brief Adds an empty slab to the end
+
+The slab is aligned to its own size, and its first unit holds its index
+*/
+void ClauseAllocator::addSlab()
+{
+    if (slabs.size() >= MAX_SLABS) {
+        cout
+        << "ERROR: memory manager can't handle the load"
+        << " slabs: " << slabs.size()
+        << " max slabs: " << MAX_SLABS
+        << endl;
+
+        throw std::bad_alloc();
+    }
+
+    void* mem = NULL;
+    #if defined(_MSC_VER) || defined(__MINGW32__)
+    mem = _aligned_malloc(SLAB_BYTES, SLAB_BYTES);
+    #else
+    if (posix_memalign(&mem, SLAB_BYTES, SLAB_BYTES) != 0) {
+        mem = NULL;
+    }
+    #endif
+
+    if (mem == NULL) {
+        cout
+        << "ERROR: while allocating clause space"
+        << endl;
+
+        throw std::bad_alloc();
+    }
+
+    #ifdef MADV_HUGEPAGE
+    madvise(mem, SLAB_BYTES, MADV_HUGEPAGE);
+    #endif
+
+    BASE_DATA_TYPE* slab = (BASE_DATA_TYPE*)mem;
+    slab[0] = slabs.size();
+    slabs.push_back(slab);
+    slabUsed.push_back(1);
+    size += 1;
+    peakNumSlabs = std::max(peakNumSlabs, slabs.size());
+}
+
+void ClauseAllocator::freeSlab(BASE_DATA_TYPE* slab)
+{
+    #if defined(_MSC_VER) || defined(__MINGW32__)
+    _aligned_free(slab);
+    #else
+    free(slab);
+    #endif
 }
 
 /**
@@ -103,6 +161,12 @@ Clause* ClauseAllocator::Clause_new(Clause& c)
     return (Clause*)mem;
 }
 
+static inline uint32_t unitsNeeded(const uint32_t clauseSize)
+{
+    return (sizeof(Clause) + sizeof(Lit)*clauseSize + sizeof(BASE_DATA_TYPE) - 1)
+        /sizeof(BASE_DATA_TYPE);
+}
+
 void* ClauseAllocator::allocEnough(
     uint32_t clauseSize
     , bool reconstruct //Are we reconstructing a solution?
@@ -113,49 +177,22 @@ void* ClauseAllocator::allocEnough(
         )
     );
 
-    //Try to quickly find a place at the end of a dataStart
-    uint32_t needed
-        = (sizeof(Clause) + sizeof(Lit)*clauseSize) /sizeof(BASE_DATA_TYPE);
-
-    if (size + needed > maxSize) {
-        //Grow by default, but don't go under or over the limits
-        size_t newMaxSize = maxSize * ALLOC_GROW_MULT;
-        newMaxSize = std::min<size_t>(newMaxSize, MAXSIZE);
-        newMaxSize = std::max<size_t>(newMaxSize, MIN_LIST_SIZE);
-
-        //Oops, not enough space anyway
-        if (newMaxSize < size + needed) {
-            cout
-            << "ERROR: memory manager can't handle the load"
-            << " size: " << size
-            << " needed: " << needed
-            << " newMaxSize: " << newMaxSize
-            << endl;
-
-            throw std::bad_alloc();
-        }
-
-        //Reallocate data
-        dataStart = (BASE_DATA_TYPE*)realloc(
-            dataStart
-            , newMaxSize*sizeof(BASE_DATA_TYPE)
-        );
-
-        //Realloc failed?
-        if (dataStart == NULL) {
-            cout
-            << "ERROR: while reallocating clause space"
-            << endl;
-
-            throw std::bad_alloc();
+    //Try to quickly find a place at the end of the last slab
+    const uint32_t needed = unitsNeeded(clauseSize);
+    assert(needed < SLAB_SIZE);
+    if (slabs.empty()
+        || slabUsed.back() + needed > SLAB_SIZE
+    ) {
+        //The rest of the last slab is wasted
+        if (!slabs.empty()) {
+            size += SLAB_SIZE - slabUsed.back();
         }
-
-        //Update maxSize to reflect the update
-        maxSize = newMaxSize;
+        addSlab();
     }
 
     //Add clause to the set
-    Clause* pointer = (Clause*)(dataStart + size);
+    Clause* pointer = (Clause*)(slabs.back() + slabUsed.back());
+    slabUsed.back() += needed;
     size += needed;
     currentlyUsedSize += needed;
     origClauseSizes.push_back(needed);
@@ -180,12 +217,16 @@ struct sortByClauseNumLookedAtDescending
 /**
 @brief Given the pointer of the clause it finds a 32-bit offset for it
 
-Calculates the stack frame and the position of the pointer in the stack, and
-rerturns a 32-bit value that is a concatenation of these two
+Slabs are aligned to their size, so the start of the slab is found by masking
+the pointer, and the slab's index is stored at its start. Returns a 32-bit
+value that is a concatenation of the index and the position in the slab
 */
 ClOffset ClauseAllocator::getOffset(const Clause* ptr) const
 {
-    return ((uint32_t*)ptr - dataStart);
+    const BASE_DATA_TYPE* slab = (const BASE_DATA_TYPE*)
+        ((uintptr_t)ptr & ~(uintptr_t)(SLAB_BYTES-1));
+
+    return (slab[0] << SLAB_BITS) | ((const BASE_DATA_TYPE*)ptr - slab);
 }
 
 /**
@@ -206,7 +247,7 @@ void ClauseAllocator::clauseFree(Clause* cl)
     assert(!cl->getFreed());
 
     cl->setFreed();
-    currentlyUsedSize -= (sizeof(Clause) + cl->size()*sizeof(Lit))/sizeof(BASE_DATA_TYPE);
+    currentlyUsedSize -= unitsNeeded(cl->size());
 }
 
 void ClauseAllocator::clauseFree(ClOffset offset)
@@ -216,12 +257,13 @@ void ClauseAllocator::clauseFree(ClOffset offset)
 }
 
 /**
-@brief If needed, compacts stacks, removing unused clauses
+@brief If needed, compacts slabs, removing unused clauses
 
 Firstly, the algorithm determines if the number of useless slots is large or
 small compared to the problem size. If it is small, it does nothing. If it is
-large, then it allocates new stacks, copies the non-freed clauses to these new
-stacks, updates all pointers and offsets, and frees the original stacks.
+large, then it moves the non-freed clauses to the front, slab by slab, updates
+all pointers and offsets, and frees the slabs that became empty. Nothing is
+allocated, so memory use never goes above what it was before.
 */
 void ClauseAllocator::consolidate(
     Solver* solver
@@ -232,7 +274,6 @@ void ClauseAllocator::consolidate(
     //If re-allocation is not really neccessary, don't do it
     //Neccesities:
     //1) There is too much memory allocated. Re-allocation will save space
-    //   Avoiding segfault (max is 16 outerOffsets, more than 10 is near)
     //2) There is too much empty, unused space (>30%)
     if (!force
         && ((double)currentlyUsedSize/(double)size > 0.7)
@@ -246,54 +287,80 @@ void ClauseAllocator::consolidate(
     //Data for new struct
     vector<uint32_t> newOrigClauseSizes;
     vector<ClOffset> newOffsets;
-    uint64_t newSize = 0;
-
-    //Pointers that will be moved along
-    BASE_DATA_TYPE* newDataStart = dataStart;
-    BASE_DATA_TYPE* tmpDataStart = dataStart;
-
-    assert(sizeof(Clause) % sizeof(BASE_DATA_TYPE) == 0);
-    assert(sizeof(Lit) % sizeof(BASE_DATA_TYPE) == 0);
-    for (auto size: origClauseSizes) {
-        Clause* clause = (Clause*)tmpDataStart;
-        //Already freed, so skip entirely
-        if (clause->freed()) {
-            tmpDataStart += size;
-            continue;
+    uint64_t newUsedSize = 0;
+
+    //Clauses are only ever moved to the front: either within the same slab,
+    //or into an earlier one. A clause that fits at its old place in a slab
+    //also fits at a lower place in the same slab.
+    size_t writeSlab = 0;
+    uint32_t writePos = 1;
+    size_t at = 0;
+    for (size_t readSlab = 0; readSlab < slabs.size(); readSlab++) {
+        uint32_t readPos = 1;
+        while(readPos < slabUsed[readSlab]) {
+            const uint32_t size = origClauseSizes[at++];
+            Clause* clause = (Clause*)(slabs[readSlab] + readPos);
+            readPos += size;
+
+            //Already freed, so skip entirely
+            if (clause->freed()) {
+                continue;
+            }
+
+            //Move to new position
+            const uint32_t sizeNeeded = unitsNeeded(clause->size());
+            assert(sizeNeeded <= size && "New clause size must not be bigger than orig clause size");
+            if (writePos + sizeNeeded > SLAB_SIZE) {
+                assert(writeSlab < readSlab);
+                slabUsed[writeSlab] = writePos;
+                writeSlab++;
+                writePos = 1;
+            }
+            memmove(slabs[writeSlab] + writePos, clause, sizeNeeded*sizeof(BASE_DATA_TYPE));
+
+            //Record position
+            newOffsets.push_back((writeSlab << SLAB_BITS) | writePos);
+
+            //Record sizes
+            newOrigClauseSizes.push_back(sizeNeeded);
+            newUsedSize += sizeNeeded;
+            writePos += sizeNeeded;
         }
+    }
+    assert(at == origClauseSizes.size());
 
-        //Move to new position
-        uint32_t sizeNeeded = (sizeof(Clause) + clause->size()*sizeof(Lit))/sizeof(BASE_DATA_TYPE);
-        assert(sizeNeeded <= size && "New clause size must not be bigger than orig clause size");
-        memmove(newDataStart, tmpDataStart, sizeNeeded*sizeof(BASE_DATA_TYPE));
+    if (!slabs.empty()) {
+        slabUsed[writeSlab] = writePos;
+    }
 
-        //Record position
-        newOffsets.push_back(newSize);
+    //Update sizes
+    const size_t oldSize = size;
+    size = writeSlab*SLAB_SIZE + writePos;
+    currentlyUsedSize = newUsedSize;
+    newOrigClauseSizes.swap(origClauseSizes);
 
-        //Record sizes
-        newOrigClauseSizes.push_back(sizeNeeded);
-        newSize += sizeNeeded;
+    //Update offsets & pointers(?) now, when everything is in memory still
+    updateAllOffsetsAndPointers(solver, newOffsets);
 
-        //Move pointers along
-        newDataStart += sizeNeeded;
-        tmpDataStart += size;
+    //Free slabs that became empty
+    const size_t oldNumSlabs = slabs.size();
+    if (!slabs.empty()) {
+        for(size_t i = writeSlab+1; i < slabs.size(); i++) {
+            freeSlab(slabs[i]);
+        }
+        slabs.resize(writeSlab+1);
+        slabUsed.resize(writeSlab+1);
     }
 
     if (solver->conf.verbosity >= 3) {
         cout << "c consolidated memory. "
-        << " Num cls:" << newOrigClauseSizes.size()
-        << " old size:" << size
-        << " new size:" << newSize
+        << " Num cls:" << origClauseSizes.size()
+        << " old size:" << oldSize
+        << " new size:" << size
+        << " slabs:" << oldNumSlabs << " -> " << slabs.size()
+        << " peak slabs: " << peakNumSlabs
         << endl;
     }
-
-    //Update offsets & pointers(?) now, when everything is in memory still
-    updateAllOffsetsAndPointers(solver, newOffsets);
-
-    //Update sizes
-    size = newSize;
-    currentlyUsedSize = newSize;
-    newOrigClauseSizes.swap(origClauseSizes);
 }
 
 void ClauseAllocator::updateAllOffsetsAndPointers(
@@ -355,7 +422,9 @@ void ClauseAllocator::updateAllOffsetsAndPointers(
 uint64_t ClauseAllocator::getMemUsed() const
 {
     uint64_t mem = 0;
-    mem += maxSize*sizeof(BASE_DATA_TYPE);
+    mem += slabs.size()*SLAB_BYTES;
+    mem += slabs.capacity()*sizeof(BASE_DATA_TYPE*);
+    mem += slabUsed.capacity()*sizeof(uint32_t);
     mem += origClauseSizes.capacity()*sizeof(uint32_t);
 
     return mem;
@@ -32,7 +32,14 @@
 
 #include "watched.h"
 
-#define BASE_DATA_TYPE uint32_t
+#define BASE_DATA_TYPE uint64_t
+
+//Offsets are slab number + position in slab, in BASE_DATA_TYPE units. Only 30
+//bits are useable, as we shift stuff around in Watched and PropBy
+#define SLAB_BITS 21
+#define SLAB_SIZE (1U << SLAB_BITS)
+#define SLAB_MASK (SLAB_SIZE - 1)
+#define MAX_SLABS (1U << (30 - SLAB_BITS))
 
 namespace CMSat {
 
@@ -46,11 +53,18 @@ using std::vector;
 /**
 @brief Allocates memory for (xor) clauses
 
-This class allocates memory in large chunks, then distributes it to clauses when
-needed. When instructed, it consolidates the unused space (i.e. clauses free()-ed).
-Essentially, it is a stack-like allocator for clauses. It is useful to have
-this, because this way, we can address clauses according to their number,
-which is 32-bit, instead of their address, which might be 64-bit
+This class allocates memory in fixed-size slabs, then distributes it to clauses
+when needed. When instructed, it consolidates the unused space (i.e. clauses
+free()-ed). Essentially, it is a stack-like allocator for clauses. It is useful
+to have this, because this way, we can address clauses according to their
+number, which is 32-bit, instead of their address, which might be 64-bit.
+
+A clause never spans two slabs. The number is the slab index in the top bits,
+and the position in the slab in 8-byte units in the bottom SLAB_BITS bits. As
+there are at most 2^30 numbers, at most 8GB can be addressed. Growth never
+moves clauses, it just adds a new slab. Slabs are aligned to their size, and
+their first unit holds their index, so getOffset() needs no lookup. Where
+possible, slabs are backed by huge pages.
 */
 class ClauseAllocator {
     public:
@@ -69,13 +83,13 @@ class ClauseAllocator {
         /**
         @brief Returns the pointer of a clause given its offset
 
-        Takes the "dataStart" of the correct stack, and adds the offset,
+        Takes the start of the slab, and adds the position in the slab,
         returning the thus created pointer. Used a LOT in propagation, thus this
         is very important to be fast (therefore, it is an inlined method)
         */
         inline Clause* getPointer(const uint32_t offset) const
         {
-            return (Clause*)(dataStart + offset);
+            return (Clause*)(slabs[offset >> SLAB_BITS] + (offset & SLAB_MASK));
         }
 
         void clauseFree(Clause* c); ///Frees memory and associated clause number
@@ -87,6 +101,8 @@ class ClauseAllocator {
         );
 
         uint64_t getMemUsed() const;
+        uint64_t getPeakMemUsed() const;
+        size_t getNumSlabs() const;
 
     private:
         void updateAllOffsetsAndPointers(
@@ -94,8 +110,13 @@ class ClauseAllocator {
             , const vector<ClOffset>& offsets
         );
 
-        BASE_DATA_TYPE* dataStart; ///<Stacks start at these positions
-        size_t size; ///<The number of BASE_DATA_TYPE datapieces currently used in each stack
+        vector<BASE_DATA_TYPE*> slabs;
+        vector<uint32_t> slabUsed; ///<Units used in each slab, including the header
+        size_t peakNumSlabs;
+        void addSlab();
+        void freeSlab(BASE_DATA_TYPE* slab);
+
+        size_t size; ///<The number of BASE_DATA_TYPE datapieces used, with wasted slab tails
         /**
         @brief Clauses in the stack had this size when they were allocated
         This my NOT be their current size: the clauses may be shrinked during
@@ -103,7 +124,6 @@ class ClauseAllocator {
         size is saved. This way, we can later move clauses around.
         */
         vector<uint32_t> origClauseSizes;
-        size_t maxSize; ///<The number of BASE_DATA_TYPE datapieces allocated
         /**
         @brief The estimated used size of the stack
         This is incremented by clauseSize each time a clause is allocated, and
@@ -116,6 +136,16 @@ class ClauseAllocator {
         void* allocEnough(const uint32_t size, const bool reconstruct);
 };
 
+inline uint64_t ClauseAllocator::getPeakMemUsed() const
+{
+    return (uint64_t)peakNumSlabs*SLAB_SIZE*sizeof(BASE_DATA_TYPE);
+}
+
+inline size_t ClauseAllocator::getNumSlabs() const
+{
+    return slabs.size();
+}
+
 } //end namespace
 
 #endif //CLAUSEALLOCATOR_H
@@ -0,0 +1,297 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "clausespill.h"
+#include "clause.h"
+#include "solver.h"
+#include "varreplacer.h"
+#include "varupdatehelper.h"
+#include "time_mem.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#define SPILL_USE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace CMSat;
+
+ClauseSpill::ClauseSpill(Solver* _solver) :
+    solver(_solver)
+    , fd(-1)
+    , data(NULL)
+    , capacity(0)
+    , used(0)
+    , numClauses(0)
+    , failed(false)
+    , usedAtReload(0)
+{
+}
+
+ClauseSpill::~ClauseSpill()
+{
+    release();
+}
+
+void ClauseSpill::release()
+{
+    #ifdef SPILL_USE_MMAP
+    if (data != NULL) {
+        munmap(data, capacity*sizeof(uint32_t));
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    #else
+    free(data);
+    #endif
+
+    fd = -1;
+    data = NULL;
+    capacity = 0;
+    used = 0;
+    numClauses = 0;
+    usedAtReload = 0;
+}
+
+/**
+@brief Makes sure there is room for at least minWords more words
+
+The file is created on first use, and is doubled every time it fills up, up
+to conf.spillMaxMB
+*/
+bool ClauseSpill::grow(const size_t minWords)
+{
+    if (failed)
+        return false;
+
+    const size_t maxWords = solver->conf.spillMaxMB*1024ULL*1024ULL/sizeof(uint32_t);
+    if (used + minWords > maxWords)
+        return false;
+
+    size_t newCapacity = std::max<size_t>(capacity*2, 1024*1024);
+    while (newCapacity < used + minWords) {
+        newCapacity *= 2;
+    }
+    newCapacity = std::min(newCapacity, maxWords);
+
+    #ifdef SPILL_USE_MMAP
+    if (fd == -1) {
+        const char* dir = getenv("TMPDIR");
+        string fileName = string(dir ? dir : "/tmp") + "/cmsat-spill-XXXXXX";
+        vector<char> name(fileName.begin(), fileName.end());
+        name.push_back(0);
+        fd = mkstemp(&name[0]);
+        if (fd == -1) {
+            if (solver->conf.verbosity >= 1) {
+                cout
+                << "c WARNING: could not create spill file in '"
+                << (dir ? dir : "/tmp")
+                << "', evicted learnt clauses will be freed"
+                << endl;
+            }
+            failed = true;
+            return false;
+        }
+
+        //Only we know about it, and it goes away when closed
+        unlink(&name[0]);
+    }
+
+    if (ftruncate(fd, newCapacity*sizeof(uint32_t)) != 0) {
+        failed = true;
+        return false;
+    }
+
+    if (data != NULL) {
+        munmap(data, capacity*sizeof(uint32_t));
+    }
+    void* mem = mmap(NULL, newCapacity*sizeof(uint32_t)
+        , PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        //The contents are in the file, but we can't map them anymore
+        data = NULL;
+        release();
+        failed = true;
+        return false;
+    }
+    data = (uint32_t*)mem;
+    #else
+    uint32_t* mem = (uint32_t*)realloc(data, newCapacity*sizeof(uint32_t));
+    if (mem == NULL) {
+        failed = true;
+        return false;
+    }
+    data = mem;
+    #endif
+
+    capacity = newCapacity;
+    return true;
+}
+
+bool ClauseSpill::spill(const Clause& cl)
+{
+    const size_t words = 2 + cl.size();
+    if (used + words > capacity
+        && !grow(words)
+    ) {
+        runStats.numSpillFull++;
+        return false;
+    }
+
+    uint32_t* rec = data + used;
+    rec[0] = cl.size();
+    rec[1] = cl.stats.glue;
+    for(size_t i = 0; i < cl.size(); i++) {
+        rec[2+i] = getUpdatedLit(cl[i], solver->interToOuterMain).toInt();
+    }
+    used += words;
+    numClauses++;
+
+    runStats.numSpilled++;
+    return true;
+}
+
+/**
+@brief Lowest activity of the conf.spillActiveRatio most active free variables
+*/
+double ClauseSpill::activityLimit()
+{
+    tmpActs.clear();
+    for(size_t i = 0; i < solver->nVars(); i++) {
+        if (solver->value(i) == l_Undef
+            && solver->varData[i].removed == Removed::none
+        ) {
+            tmpActs.push_back(solver->activities[i]);
+        }
+    }
+    if (tmpActs.empty())
+        return 0;
+
+    const size_t at = std::min<size_t>(
+        tmpActs.size()-1
+        , (double)tmpActs.size()*solver->conf.spillActiveRatio
+    );
+    std::nth_element(tmpActs.begin(), tmpActs.begin() + at, tmpActs.end()
+        , std::greater<uint32_t>());
+
+    //Variables never bumped are not active
+    return std::max<uint32_t>(tmpActs[at], 1);
+}
+
+bool ClauseSpill::reload()
+{
+    assert(solver->decisionLevel() == 0);
+    if (numClauses == 0)
+        return solver->ok;
+
+    const double myTime = cpuTime();
+    runStats.numReloadCalls++;
+    if (solver->ok && solver->qhead != solver->trail.size()) {
+        solver->ok = solver->propagate().isNULL();
+    }
+    const double limit = activityLimit();
+
+    size_t i = 0;
+    size_t j = 0;
+    size_t newNumClauses = 0;
+    while(i < used) {
+        const size_t size = data[i];
+        const uint32_t glue = data[i+1];
+        const size_t words = 2 + size;
+
+        lits.clear();
+        bool drop = false;
+        size_t numFree = 0;
+        size_t numActive = 0;
+        for(size_t k = 0; k < size; k++) {
+            Lit lit = Lit::toLit(data[i+2+k]);
+            if (!solver->outerToImportable(lit)
+                || solver->value(lit) == l_True
+            ) {
+                drop = true;
+                break;
+            }
+
+            if (solver->value(lit) == l_Undef) {
+                numFree++;
+                numActive += (solver->activities[lit.var()] >= limit);
+            }
+            lits.push_back(lit);
+        }
+
+        //Reload if it propagates, or the majority of its free variables
+        //are active. What has just been evicted gets one round off
+        const bool doReload = !drop
+            && solver->ok
+            && (numFree <= 1
+                || (i < usedAtReload && numActive*2 > numFree));
+
+        if (drop) {
+            runStats.numDropped++;
+        } else if (!doReload) {
+            if (i != j) {
+                memmove(data + j, data + i, words*sizeof(uint32_t));
+            }
+            j += words;
+            newNumClauses++;
+        }
+
+        if (doReload) {
+            runStats.numReloaded++;
+            ClauseStats stats;
+            stats.glue = glue;
+            stats.conflictNumIntroduced = solver->sumConflicts();
+            Clause* cl = solver->addClauseInt(lits, true, stats);
+            if (cl != NULL) {
+                solver->longRedCls.push_back(solver->clAllocator->getOffset(cl));
+            }
+        }
+        i += words;
+    }
+    used = j;
+    usedAtReload = used;
+    numClauses = newNumClauses;
+
+    runStats.cpu_time = cpuTime() - myTime;
+    if (solver->conf.verbosity >= 2) {
+        runStats.printShort();
+    }
+    globalStats += runStats;
+    runStats.clear();
+
+    return solver->ok;
+}
+
+uint64_t ClauseSpill::memUsed() const
+{
+    uint64_t mem = 0;
+    #ifndef SPILL_USE_MMAP
+    mem += capacity*sizeof(uint32_t);
+    #endif
+    mem += tmpActs.capacity()*sizeof(uint32_t);
+    mem += lits.capacity()*sizeof(Lit);
+
+    return mem;
+}
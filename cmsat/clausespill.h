@@ -0,0 +1,185 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __CLAUSESPILL_H__
+#define __CLAUSESPILL_H__
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+class Solver;
+class Clause;
+using std::vector;
+using std::cout;
+using std::endl;
+
+/**
+@brief Out-of-core store of evicted, but still promising, learnt clauses
+
+When reduceDB() evicts a clause whose glue is low enough to be in tier2, the
+clause is written here instead of being thrown away. The store is a
+memory-mapped, already unlinked, temporary file, so the pages can be written
+back to disk by the kernel and do not count towards the resident set. Clauses
+are stored in OUTER numbering, so they survive renumbering.
+
+Every record is:
+    size, glue, lit[0] ... lit[size-1]
+
+reload() goes through all records. Clauses whose variables are active again
+(i.e. have a high VSIDS activity) are added back as learnt clauses, except
+for the ones spilled since the previous reload. Clauses that are satisfied, or contain an eliminated variable, are dropped. The rest
+are compacted to the front of the file.
+
+On Windows, there is no mmap, and the store is simply kept on the heap
+*/
+class ClauseSpill
+{
+    public:
+        ClauseSpill(Solver* solver);
+        ~ClauseSpill();
+
+        //Store clause (internal numbering). Returns FALSE if full
+        bool spill(const Clause& cl);
+
+        //Add back active clauses. Must be called at decision level 0
+        bool reload();
+
+        size_t getNumClauses() const;
+        uint64_t memUsed() const;
+
+        struct Stats
+        {
+            Stats() :
+                numSpilled(0)
+                , numSpillFull(0)
+                , numReloaded(0)
+                , numDropped(0)
+                , numReloadCalls(0)
+                , cpu_time(0)
+            {}
+
+            void clear()
+            {
+                Stats tmp;
+                *this = tmp;
+            }
+
+            Stats& operator+=(const Stats& other)
+            {
+                numSpilled += other.numSpilled;
+                numSpillFull += other.numSpillFull;
+                numReloaded += other.numReloaded;
+                numDropped += other.numDropped;
+                numReloadCalls += other.numReloadCalls;
+                cpu_time += other.cpu_time;
+
+                return *this;
+            }
+
+            void print() const
+            {
+                cout << "c -------- CLAUSE SPILL STATS --------" << endl;
+                printStatsLine("c spilled cls"
+                    , numSpilled
+                );
+                printStatsLine("c spill full, freed cls"
+                    , numSpillFull
+                );
+                printStatsLine("c reloaded cls"
+                    , numReloaded
+                    , 100.0*(double)numReloaded/(double)numSpilled
+                    , "% of spilled"
+                );
+                printStatsLine("c dropped cls"
+                    , numDropped
+                    , 100.0*(double)numDropped/(double)numSpilled
+                    , "% of spilled"
+                );
+                printStatsLine("c reload time"
+                    , cpu_time
+                    , cpu_time/(double)numReloadCalls
+                    , "per call"
+                );
+                cout << "c -------- CLAUSE SPILL STATS END --------" << endl;
+            }
+
+            void printShort() const
+            {
+                cout
+                << "c [spill]"
+                << " spilled: " << numSpilled
+                << " reloaded: " << numReloaded
+                << " dropped: " << numDropped
+                << " T: " << std::fixed << std::setprecision(2)
+                << cpu_time << " s"
+                << endl;
+            }
+
+            uint64_t numSpilled;
+            uint64_t numSpillFull;
+            uint64_t numReloaded;
+            uint64_t numDropped;
+            uint64_t numReloadCalls;
+            double cpu_time;
+        };
+
+        const Stats& getStats() const;
+
+    private:
+        Solver* solver;
+
+        //Storage
+        bool grow(const size_t minWords);
+        void release();
+        int       fd;
+        uint32_t* data;
+        size_t    capacity; ///<Size of the mapping, in words
+        size_t    used; ///<Words used, all at the front
+        size_t    numClauses;
+        bool      failed; ///<Couldn't create or grow the file, don't try again
+        size_t    usedAtReload; ///<Records after this were spilled since the last reload
+
+        //Reload
+        double activityLimit();
+        vector<uint32_t> tmpActs;
+        vector<Lit> lits;
+
+        Stats runStats;
+        Stats globalStats;
+};
+
+inline size_t ClauseSpill::getNumClauses() const
+{
+    return numClauses;
+}
+
+inline const ClauseSpill::Stats& ClauseSpill::getStats() const
+{
+    return globalStats;
+}
+
+} //end namespace
+
+#endif //__CLAUSESPILL_H__
@@ -40,6 +40,7 @@ using std::endl;
 ClauseVivifier::ClauseVivifier(Solver* _solver) :
     solver(_solver)
     , numCalls(0)
+    , lastLearntConfl(0)
 {}
 
 bool ClauseVivifier::vivify(const bool alsoStrengthen)
@@ -420,6 +421,228 @@ ClOffset ClauseVivifier::testVivify(
         return offset;
     }
 }
+
+struct LitActivitySorter
+{
+    LitActivitySorter(const vector<uint32_t>& _activities) :
+        activities(_activities)
+    {}
+
+    bool operator()(const Lit a, const Lit b) const
+    {
+        if (activities[a.var()] != activities[b.var()])
+            return activities[a.var()] > activities[b.var()];
+
+        return a < b;
+    }
+
+    const vector<uint32_t>& activities;
+};
+
+/**
+@brief Vivifies the learnt clauses that are kept in the long run
+
+These are the core (tier1) and the not-yet-demoted tier2 learnt clauses. The
+literals of every candidate are ordered by decreasing activity, and the
+candidates are ordered lexicographically by them, so consecutive candidates
+often start with the same literals. The decisions of such a shared prefix are
+kept on the trail instead of being re-propagated.
+
+The propagation budget is proportional to the conflicts since the last call.
+Must be called at decision level 0
+*/
+bool ClauseVivifier::vivifyLearnt()
+{
+    assert(solver->ok);
+    assert(solver->decisionLevel() == 0);
+
+    const double myTime = cpuTime();
+    const uint64_t sumConfl = solver->sumConflicts();
+    const uint64_t maxNumProps =
+        (sumConfl - lastLearntConfl)*solver->conf.vivifLearntPropsPerConfl;
+    lastLearntConfl = sumConfl;
+    Stats::LearntAsymm& stats = runStats.learntAsymm;
+    stats.numCalled = 1;
+
+    //Collect the candidates not yet tried, literals ordered by activity
+    learntCands.clear();
+    learntCandLits.clear();
+    for(vector<ClOffset>::const_iterator
+        it = solver->longRedCls.begin(), end = solver->longRedCls.end()
+        ; it != end
+        ; it++
+    ) {
+        const Clause& cl = *solver->clAllocator->getPointer(*it);
+        if (cl.stats.glue > solver->conf.glueTier2Max || cl.getDemoted())
+            continue;
+
+        stats.totalCls++;
+        if (cl.getAsymmed())
+            continue;
+
+        const uint32_t start = learntCandLits.size();
+        learntCands.push_back(LearntCand(*it, start, cl.size()));
+        learntCandLits.insert(learntCandLits.end(), cl.begin(), cl.end());
+        std::sort(
+            learntCandLits.begin() + start
+            , learntCandLits.end()
+            , LitActivitySorter(solver->activities)
+        );
+    }
+    std::sort(
+        learntCands.begin()
+        , learntCands.end()
+        , LearntCandSorter(learntCandLits)
+    );
+
+    //Vivify until budget runs out
+    extraTime = learntCandLits.size()/4;
+    const uint64_t oldBogoProps = solver->propStats.bogoProps;
+    newLearnts.clear();
+    decided.clear();
+    for(vector<LearntCand>::const_iterator
+        it = learntCands.begin(), end = learntCands.end()
+        ; it != end && solver->ok
+        ; it++
+    ) {
+        if (solver->propStats.bogoProps-oldBogoProps + extraTime > maxNumProps) {
+            stats.ranOutOfTime++;
+            break;
+        }
+
+        vivifyLearntCl(*it);
+    }
+    if (solver->decisionLevel() > 0)
+        solver->cancelZeroLight();
+
+    //Replaced clauses have been freed, shortened ones are new
+    vector<ClOffset>::iterator i, j;
+    i = j = solver->longRedCls.begin();
+    for (vector<ClOffset>::iterator end = solver->longRedCls.end()
+        ; i != end
+        ; i++
+    ) {
+        if (!solver->clAllocator->getPointer(*i)->freed())
+            *j++ = *i;
+    }
+    solver->longRedCls.resize(solver->longRedCls.size() - (i-j));
+    solver->longRedCls.insert(
+        solver->longRedCls.end()
+        , newLearnts.begin()
+        , newLearnts.end()
+    );
+
+    //If went through all of them, start from the beginning next time
+    if (!stats.ranOutOfTime) {
+        for (vector<ClOffset>::const_iterator
+            it = solver->longRedCls.begin(), end = solver->longRedCls.end()
+            ; it != end
+            ; it++
+        ) {
+            solver->clAllocator->getPointer(*it)->setAsymmed(false);
+        }
+    }
+
+    //Stats
+    stats.cpu_time = cpuTime() - myTime;
+    if (solver->conf.verbosity >= 2) {
+        stats.printShort();
+    }
+    globalStats += runStats;
+    runStats.clear();
+
+    return solver->ok;
+}
+
+void ClauseVivifier::vivifyLearntCl(const LearntCand& cand)
+{
+    Stats::LearntAsymm& stats = runStats.learntAsymm;
+    const Lit* clLits = &learntCandLits[cand.start];
+    solver->clAllocator->getPointer(cand.offset)->setAsymmed(true);
+    stats.triedCls++;
+    extraTime += cand.size;
+
+    //Keep the decisions shared with the previous candidate. Not all of them
+    //though, as that would be a conflict
+    uint32_t keep = 0;
+    while (keep < decided.size()
+        && keep+1 < cand.size
+        && decided[keep] == clLits[keep]
+    ) {
+        keep++;
+    }
+    if (solver->decisionLevel() > keep) {
+        solver->cancelUntilLight(keep);
+        decided.resize(keep);
+    }
+    stats.reusedDecisions += keep;
+
+    //Falsify the literals one by one, dropping the ones implied FALSE, and
+    //stopping at a conflict, or at a literal implied TRUE
+    lits.clear();
+    for (uint32_t i = 0; i < cand.size; i++) {
+        const Lit lit = clLits[i];
+        if (i < keep) {
+            lits.push_back(lit);
+            continue;
+        }
+
+        const lbool val = solver->value(lit);
+        if (val == l_False)
+            continue;
+
+        lits.push_back(lit);
+        if (val == l_True)
+            break;
+
+        solver->newDecisionLevel();
+        solver->enqueue(~lit);
+        decided.push_back(lit);
+        stats.decisions++;
+        extraTime += 5;
+        if (!solver->propagate().isNULL()) {
+            solver->cancelUntilLight(solver->decisionLevel()-1);
+            decided.pop_back();
+            break;
+        }
+    }
+
+    if (lits.size() == cand.size)
+        return;
+
+    //Replace with the shortened clause, which needs decision level 0
+    if (solver->decisionLevel() > 0)
+        solver->cancelZeroLight();
+    decided.clear();
+    extraTime += 20;
+
+    bool satisfied = false;
+    for(vector<Lit>::const_iterator
+        it = lits.begin(), end = lits.end()
+        ; it != end
+        ; it++
+    ) {
+        satisfied |= (solver->value(*it) == l_True);
+    }
+    if (satisfied) {
+        stats.removed++;
+    } else {
+        stats.shortened++;
+        stats.numLitsRem += cand.size - lits.size();
+    }
+
+    ClauseStats clStats = solver->clAllocator->getPointer(cand.offset)->stats;
+    clStats.glue = std::min<uint32_t>(clStats.glue, lits.size());
+    Clause* cl2 = solver->addClauseInt(lits, true, clStats);
+    solver->detachClause(cand.offset);
+    solver->clAllocator->clauseFree(cand.offset);
+
+    if (cl2 != NULL) {
+        cl2->setAsymmed(true);
+        newLearnts.push_back(solver->clAllocator->getOffset(cl2));
+    }
+}
+
 bool ClauseVivifier::vivifyClausesCache(
     vector<ClOffset>& clauses
     , bool learnt
@@ -1007,6 +1230,7 @@ void ClauseVivifier::subsumeImplicit()
             }
         }
         ws.shrink(i-j);
+        moveBinsToFront(ws);
     }
 
     if (solver->conf.verbosity >= 1) {
@@ -23,6 +23,7 @@
 #define CLAUSEVIVIFIER_H
 
 #include <vector>
+#include <algorithm>
 #include "clause.h"
 #include "constants.h"
 #include "solvertypes.h"
@@ -39,6 +40,7 @@ class ClauseVivifier {
     public:
         ClauseVivifier(Solver* solver);
         bool vivify(bool alsoStrengthen);
+        bool vivifyLearnt(); ///<Vivify tier1 and tier2 learnt clauses. Called between restarts
         void subsumeImplicit();
         bool strengthenImplicit();
 
@@ -77,6 +79,9 @@ class ClauseVivifier {
                 irredCacheBased += other.irredCacheBased;
                 redCacheBased += other.redCacheBased;
 
+                //Learnt during search
+                learntAsymm += other.learntAsymm;
+
                 return *this;
             }
 
@@ -136,6 +141,9 @@ class ClauseVivifier {
 
                 cout << "c --> cache-based on red cls" << endl;
                 redCacheBased.print();
+
+                cout << "c --> asymm on tier1/tier2 red cls during search" << endl;
+                learntAsymm.print();
                 cout << "c -------- ASYMM STATS END --------" << endl;
             }
 
@@ -245,6 +253,105 @@ class ClauseVivifier {
 
             CacheBased irredCacheBased;
             CacheBased redCacheBased;
+
+            //Asymm on tier1/tier2 learnt, during search
+            struct LearntAsymm
+            {
+                double cpu_time;
+                uint64_t numLitsRem;
+                uint64_t shortened;
+                uint64_t removed;
+                uint64_t triedCls;
+                uint64_t totalCls;
+                uint64_t decisions;
+                uint64_t reusedDecisions;
+                uint64_t ranOutOfTime;
+                uint64_t numCalled;
+
+                LearntAsymm() :
+                    cpu_time(0)
+                    , numLitsRem(0)
+                    , shortened(0)
+                    , removed(0)
+                    , triedCls(0)
+                    , totalCls(0)
+                    , decisions(0)
+                    , reusedDecisions(0)
+                    , ranOutOfTime(0)
+                    , numCalled(0)
+                {}
+
+                void printShort() const
+                {
+                    cout << "c [vivif] learnt"
+                    << " cl tried " << std::setw(6) << triedCls
+                    << "/" << totalCls
+                    << " cl-sh " << std::setw(5) << shortened
+                    << " cl-rem " << std::setw(4) << removed
+                    << " lit-rem " << std::setw(6) << numLitsRem
+                    << " dec-reused " << std::fixed << std::setprecision(1)
+                    << (double)reusedDecisions/(double)(decisions + reusedDecisions)*100.0
+                    << " %"
+                    << " time-out " << (ranOutOfTime ? "Y" : "N")
+                    << " T: " << std::setprecision(2) << cpu_time
+                    << endl;
+                }
+
+                void print() const
+                {
+                    printStatsLine("c time"
+                        , cpu_time
+                        , cpu_time/(double)numCalled
+                        , "s/call"
+                    );
+
+                    printStatsLine("c shrinked/tried/total"
+                        , shortened
+                        , triedCls
+                        , totalCls
+                    );
+
+                    printStatsLine("c removed/tried/total"
+                        , removed
+                        , triedCls
+                        , totalCls
+                    );
+
+                    printStatsLine("c lits-rem"
+                        , numLitsRem
+                    );
+
+                    printStatsLine("c decisions reused"
+                        , reusedDecisions
+                        , (double)reusedDecisions/(double)(decisions + reusedDecisions)*100.0
+                        , "% of decisions"
+                    );
+
+                    printStatsLine("c called "
+                        , numCalled
+                        , (double)ranOutOfTime/(double)numCalled*100.0
+                        , "% ran out of time"
+                    );
+                }
+
+                LearntAsymm& operator+=(const LearntAsymm& other)
+                {
+                    cpu_time += other.cpu_time;
+                    numLitsRem += other.numLitsRem;
+                    shortened += other.shortened;
+                    removed += other.removed;
+                    triedCls += other.triedCls;
+                    totalCls += other.totalCls;
+                    decisions += other.decisions;
+                    reusedDecisions += other.reusedDecisions;
+                    ranOutOfTime += other.ranOutOfTime;
+                    numCalled += other.numCalled;
+
+                    return  *this;
+                }
+            };
+
+            LearntAsymm learntAsymm;
         };
 
         const Stats& getStats() const;
@@ -267,6 +374,41 @@ class ClauseVivifier {
         );
         int64_t timeAvailable;
 
+        //Asymm on tier1/tier2 learnt clauses during search
+        struct LearntCand
+        {
+            LearntCand(const ClOffset _offset, const uint32_t _start, const uint32_t _size) :
+                offset(_offset)
+                , start(_start)
+                , size(_size)
+            {}
+
+            ClOffset offset;
+            uint32_t start; ///<Literals ordered by activity start here in learntCandLits
+            uint32_t size;
+        };
+        struct LearntCandSorter
+        {
+            LearntCandSorter(const vector<Lit>& _lits) :
+                lits(_lits)
+            {}
+
+            bool operator()(const LearntCand& a, const LearntCand& b) const
+            {
+                return std::lexicographical_compare(
+                    lits.begin() + a.start, lits.begin() + a.start + a.size
+                    , lits.begin() + b.start, lits.begin() + b.start + b.size
+                );
+            }
+
+            const vector<Lit>& lits;
+        };
+        void vivifyLearntCl(const LearntCand& cand);
+        vector<LearntCand> learntCands;
+        vector<Lit> learntCandLits;
+        vector<Lit> decided; ///<Literals of the clause falsified at each decision level
+        vector<ClOffset> newLearnts;
+
 
         //Subsumtion of bin with bin
         struct WatchSorter {
@@ -317,6 +459,7 @@ class ClauseVivifier {
         Stats runStats;
         Stats globalStats;
         size_t numCalls;
+        uint64_t lastLearntConfl; ///<Conflicts at the last vivifyLearnt()
 
 };
 
@@ -24,6 +24,7 @@
 #include <map>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include "compfinder.h"
 #include "time_mem.h"
 #include "cloffset.h"
@@ -40,13 +41,8 @@ using std::endl;
 
 //#define VERBOSE_DEBUG
 
-
-
-//#define PART_FINDING
-
 CompFinder::CompFinder(Solver* _solver) :
     timeUsed(0)
-    , timedout(false)
     , solver(_solver)
 {
 }
@@ -55,12 +51,6 @@ bool CompFinder::findComps()
 {
     const double myTime = cpuTime();
 
-    table.clear();
-    table.resize(solver->nVars(), std::numeric_limits<uint32_t>::max());
-    reverseTable.clear();
-    comp_no = 0;
-    used_comp_no = 0;
-
     solver->clauseCleaner->removeAndCleanAll();
 
     if (solver->conf.doFindAndReplaceEqLits
@@ -69,29 +59,21 @@ bool CompFinder::findComps()
         return false;
     }
 
-    //Add the clauses to the sets
+    //Every var is its own comp
+    parent.resize(solver->nVars());
+    for (size_t var = 0; var < solver->nVars(); var++) {
+        parent[var] = var;
+    }
+    compSize.clear();
+    compSize.resize(solver->nVars(), 1);
+    inClause.clear();
+    inClause.resize(solver->nVars(), 0);
+
+    //Merge the vars of the clauses
     timeUsed = 0;
-    timedout = false;
     addToCompClauses(solver->longIrredCls);
     addToCompImplicits();
-
-    //We timed-out while searching, internal datas are wrong!
-    if (timedout) {
-        if (solver->conf.verbosity >= 2) {
-            cout
-            << "c Timed out finding components, BP: "
-            << std::setprecision(2) << std::fixed
-            << (double)timeUsed/(1000.0*1000.0)
-            << " T: "
-            << std::setprecision(2) << std::fixed
-            << cpuTime() - myTime
-            << endl;
-        }
-
-        return solver->okay();
-    }
-
-    //const uint32_t comps = setComps();
+    buildTables();
 
     #ifndef NDEBUG
     for (map<uint32_t, vector<Var> >::const_iterator
@@ -106,7 +88,7 @@ bool CompFinder::findComps()
     #endif
 
     if (solver->conf.verbosity  >= 2
-        || (solver->conf.verbosity  >=1 && used_comp_no > 1)
+        || (solver->conf.verbosity  >=1 && reverseTable.size() > 1)
     ) {
         cout
         << "c Found component(s): " <<  reverseTable.size()
@@ -151,202 +133,83 @@ bool CompFinder::findComps()
 void CompFinder::addToCompClauses(const vector<ClOffset>& cs)
 {
     for (ClOffset offset: cs) {
-        if (timeUsed/(1000ULL*1000ULL) > solver->conf.compFindLimitMega) {
-            timedout = true;
-            break;
+        const Clause& cl = *solver->clAllocator->getPointer(offset);
+        timeUsed += cl.size();
+        const Var var = cl[0].var();
+        inClause[var] = true;
+        for (size_t i = 1; i < cl.size(); i++) {
+            inClause[cl[i].var()] = true;
+            merge(var, cl[i].var());
         }
-        timeUsed += 10;
-        Clause* cl = solver->clAllocator->getPointer(offset);
-        addToCompClause(*cl);
     }
 }
 
 void CompFinder::addToCompImplicits()
 {
-    vector<Lit> lits;
-    vector<uint16_t>& seen = solver->seen;
-
-    for (size_t var = 0; var < solver->nVars(); var++) {
-        if (timeUsed/(1000ULL*1000ULL) > solver->conf.compFindLimitMega) {
-            timedout = true;
-            break;
-        }
-
-        timeUsed += 2;
-        Lit lit(var, false);
-        lits.clear();
-        lits.push_back(lit);
-        for(int sign = 0; sign < 2; sign++) {
-            lit = Lit(var, sign);
-            vec<Watched>& ws = solver->watches[lit.toInt()];
-
-            //If empty, skip
-            if (ws.empty())
-                continue;
-
-            timeUsed += ws.size() + 10;
-            for(vec<Watched>::const_iterator
-                it2 = ws.begin(), end2 = ws.end()
-                ; it2 != end2
-                ; it2++
+    for (size_t wsLit = 0; wsLit < solver->nVars()*2; wsLit++) {
+        const Lit lit = Lit::toLit(wsLit);
+        const vec<Watched>& ws = solver->watches[wsLit];
+        timeUsed += ws.size() + 2;
+        for(vec<Watched>::const_iterator
+            it = ws.begin(), end = ws.end()
+            ; it != end
+            ; it++
+        ) {
+            //Only non-learnt, and each only once: from its smallest literal
+            if (it->isClause()
+                || it->learnt()
+                || lit > it->lit2()
+                || (it->isTri() && lit > it->lit3())
             ) {
-                if (it2->isBinary()
-                    //Only non-learnt
-                    && !it2->learnt()
-                    //Only do each binary once
-                    && lit < it2->lit2()
-                ) {
-                    if (!seen[it2->lit2().var()]) {
-                        lits.push_back(it2->lit2());
-                        seen[it2->lit2().var()] = 1;
-                    }
-                }
-
-                if (it2->isTri()
-                    //Non-learnt
-                    && !it2->learnt()
-                    //Only do each tri once
-                    && lit < it2->lit3()
-                    && it2->lit2() < it2->lit3()
-                ) {
-                    if (!seen[it2->lit2().var()]) {
-                        lits.push_back(it2->lit2());
-                        seen[it2->lit2().var()] = 1;
-                    }
-
-                    if (!seen[it2->lit3().var()]) {
-                        lits.push_back(it2->lit3());
-                        seen[it2->lit3().var()] = 1;
-                    }
-                }
+                continue;
             }
-        }
 
-        if (lits.size() > 1) {
-            //Clear seen
-            for(vector<Lit>::const_iterator
-                it = lits.begin(), end = lits.end()
-                ; it != end
-                ; it++
-            ) {
-                seen[it->var()] = 0;
+            inClause[lit.var()] = true;
+            inClause[it->lit2().var()] = true;
+            merge(lit.var(), it->lit2().var());
+            if (it->isTri()) {
+                inClause[it->lit3().var()] = true;
+                merge(lit.var(), it->lit3().var());
             }
-
-            addToCompClause(lits);
         }
-
     }
 }
 
-template<class T>
-void CompFinder::addToCompClause(const T& cl)
+/**
+@brief Numbers the comps of the vars that are in some clause, in var order
+*/
+void CompFinder::buildTables()
 {
-    assert(cl.size() > 1);
-    tomerge.clear();
-    newSet.clear();
-    vector<uint16_t>& seen = solver->seen;
-    timeUsed += cl.size()/2 + 1;
-
-    //Do they all belong to the same place?
-    bool allsame = false;
-    if (table[cl[0].var()] != std::numeric_limits<uint32_t>::max()) {
-        uint32_t comp = table[cl[0].var()];
-        allsame = true;
-        for (typename T::const_iterator
-            it = cl.begin(), end = cl.end()
-            ; it != end
-            ; it++
-        ) {
-            if (table[it->var()] != comp) {
-                allsame = false;;
-                break;
-            }
-        }
-    }
-
-    //They already all belong to the same comp, skip
-    if (allsame) {
-        return;
-    }
-
-    //Where should each literal go?
-    timeUsed += cl.size()*2;
-    for (typename T::const_iterator
-        it = cl.begin(), end = cl.end()
-        ; it != end
-        ; it++
-    ) {
-        if (table[it->var()] != std::numeric_limits<uint32_t>::max()
-        ) {
-            if (!seen[table[it->var()]]) {
-                tomerge.push_back(table[it->var()]);
-                seen[table[it->var()]] = 1;
-            }
-        } else {
-            newSet.push_back(it->var());
-        }
-    }
+    const uint32_t noComp = std::numeric_limits<uint32_t>::max();
+    table.clear();
+    table.resize(solver->nVars(), noComp);
+    reverseTable.clear();
 
-    //no trees to merge, only merge the clause into one tree
-    if (tomerge.size() == 1) {
-        const uint32_t into = *tomerge.begin();
-        seen[into] = 0;
-        map<uint32_t, vector<Var> >::iterator intoReverse
-            = reverseTable.find(into);
+    //Index of the comp of the root
+    vector<uint32_t> rootComp(solver->nVars(), noComp);
+    vector<vector<Var> > comps;
+    for (size_t var = 0; var < solver->nVars(); var++) {
+        if (!inClause[var])
+            continue;
 
-        //Put the new lits into this set
-        for (vector<Var>::const_iterator
-            it = newSet.begin(), end = newSet.end()
-            ; it != end
-            ; it++
-        ) {
-            intoReverse->second.push_back(*it);
-            table[*it] = into;
+        const Var root = findRoot(var);
+        if (rootComp[root] == noComp) {
+            rootComp[root] = comps.size();
+            comps.push_back(vector<Var>());
+            comps.back().reserve(compSize[root]);
         }
-        return;
-    }
-
-    //Expensive merging coming up
-    timeUsed += 20;
-
-    //Delete tables to merge and put their elements into newSet
-    for (vector<uint32_t>::iterator
-        it = tomerge.begin(), end = tomerge.end()
-        ; it != end
-        ; it++
-    ) {
-        //Clear seen
-        seen[*it] = 0;
-
-        //Find in reverseTable
-        timeUsed += reverseTable.size()*2;
-        map<uint32_t, vector<Var> >::iterator it2 =
-            reverseTable.find(*it);
-        assert(it2 != reverseTable.end());
-
-        //Add them all
-        timeUsed += it2->second.size();
-        newSet.insert(
-            newSet.end()
-            , it2->second.begin()
-            , it2->second.end()
-        );
-
-        //Delete this comp
-        timeUsed += reverseTable.size();
-        reverseTable.erase(it2);
-        used_comp_no--;
+        table[var] = rootComp[root];
+        comps[rootComp[root]].push_back(var);
     }
-
-    //Mark all these lits as belonging to comp_no
-    timeUsed += newSet.size();
-    for (size_t i = 0; i < newSet.size(); i++) {
-        table[newSet[i]] = comp_no;
+    timeUsed += solver->nVars();
+
+    //Comps are numbered in order, so every insert is at the end
+    for (size_t i = 0; i < comps.size(); i++) {
+        reverseTable.insert(
+            reverseTable.end()
+            , std::make_pair((uint32_t)i, vector<Var>())
+        )->second.swap(comps[i]);
     }
-
-    reverseTable[comp_no] = newSet;
-    comp_no++;
-    used_comp_no++;
 }
 
 /*
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 #include "constants.h"
 #include "solvertypes.h"
 #include "cloffset.h"
@@ -37,12 +38,22 @@ using std::map;
 using std::vector;
 using std::pair;
 
+/**
+@brief Finds the disconnected components of the irredundant clauses
+
+A union-find over the variables (with path compression and union by size) is
+built in one linear pass over the long irredundant clauses and the irredundant
+implicit clauses. This is cheap enough to redo at every simplification, which
+is how the components that appear during search, as variables are set,
+eliminated or replaced and clauses are removed, are detected: a union-find
+cannot split a component when a clause is removed, so it is not updated in
+place.
+*/
 class CompFinder {
 
     public:
         CompFinder(Solver* solver);
         bool findComps();
-        bool getTimedOut() const;
 
         const map<uint32_t, vector<Var> >& getReverseTable() const; // comp->var
         uint32_t getVarComp(const Var var) const;
@@ -52,23 +63,14 @@ class CompFinder {
     private:
         void addToCompImplicits();
         void addToCompClauses(const vector<ClOffset>& cs);
-        template<class T>
-        void addToCompClause(const T& cl);
-
-        struct MySorter
-        {
-            bool operator () (
-                const pair<uint32_t, uint32_t>& left
-                , const pair<uint32_t, uint32_t>& right
-            ) {
-                return left.second < right.second;
-            }
-        };
-
-        /*const uint32_t setComps();
-        template<class T>
-        void calcIn(const vec<T*>& cs, vector<uint32_t>& numClauseInComp, vector<uint32_t>& sumLitsInComp);
-        void calcInBins(vector<uint32_t>& numClauseInComp, vector<uint32_t>& sumLitsInComp);*/
+        void buildTables();
+
+        //Union-find
+        Var findRoot(Var var);
+        void merge(Var var1, Var var2);
+        vector<Var> parent;
+        vector<uint32_t> compSize; ///<Only valid for roots
+        vector<char> inClause; ///<Var is in some irredundant clause
 
         //comp -> vars
         map<uint32_t, vector<Var> > reverseTable;
@@ -76,50 +78,57 @@ class CompFinder {
         //var -> comp
         vector<uint32_t> table;
 
-        //The comp counter
-        uint32_t comp_no;
-        uint32_t used_comp_no;
-
-        //Temporary
-        vector<Var> newSet;
-        vector<uint32_t> tomerge;
-
         //Keep track of time
         uint64_t timeUsed;
-        bool timedout;
 
         Solver* solver;
 };
 
+inline Var CompFinder::findRoot(Var var)
+{
+    //Path halving
+    while (parent[var] != var) {
+        parent[var] = parent[parent[var]];
+        var = parent[var];
+    }
+    return var;
+}
+
+inline void CompFinder::merge(Var var1, Var var2)
+{
+    var1 = findRoot(var1);
+    var2 = findRoot(var2);
+    if (var1 == var2)
+        return;
+
+    //Union by size
+    if (compSize[var1] < compSize[var2])
+        std::swap(var1, var2);
+
+    parent[var2] = var1;
+    compSize[var1] += compSize[var2];
+}
+
 inline const map<uint32_t, vector<Var> >& CompFinder::getReverseTable() const
 {
-    assert(!timedout);
     return reverseTable;
 }
 
-inline const vector<Var>& CompFinder::getTable() const
+inline const vector<uint32_t>& CompFinder::getTable() const
 {
-    assert(!timedout);
     return table;
 }
 
 inline uint32_t CompFinder::getVarComp(const Var var) const
 {
-    assert(!timedout);
     return table[var];
 }
 
 inline const vector<Var>& CompFinder::getCompVars(const uint32_t comp)
 {
-    assert(!timedout);
     return reverseTable[comp];
 }
 
-inline bool CompFinder::getTimedOut() const
-{
-    return timedout;
-}
-
 } //End namespace
 
 #endif //PARTFINDER_H
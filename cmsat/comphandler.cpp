@@ -70,9 +70,6 @@ bool CompHandler::handle()
     if (!compFinder->findComps()) {
         return false;
     }
-    if (compFinder->getTimedOut()) {
-        return solver->okay();
-    }
 
     const uint32_t num_comps = compFinder->getReverseTable().size();
 
@@ -667,7 +664,7 @@ void CompHandler::readdRemovedClauses()
     size_t at = 0;
     for (uint32_t sz: removedClauses.sizes) {
 
-        //addClause() needs *outer* literals, so just do that
+        //addClauseOuter() needs *outer* literals, so just do that
         tmp.clear();
         for(size_t i = at; i < at + sz; i++) {
             tmp.push_back(removedClauses.lits[i]);
@@ -677,7 +674,7 @@ void CompHandler::readdRemovedClauses()
         }
 
         //Add the clause to the system
-        solver->addClause(tmp);
+        solver->addClauseOuter(tmp);
         assert(solver->okay());
 
         //Move 'at' along
@@ -154,7 +154,7 @@ void DimacsParser::readClause(StreamBuffer& in, vector<Lit>& lits)
                 exit(-1);
             }
 
-            while (var >= solver->nVars())
+            while (var >= solver->nVarsOutside())
                 solver->newVar();
         }
         lits.push_back( (parsed_lit > 0) ? Lit(var, false) : Lit(var, true) );
@@ -252,7 +252,7 @@ void DimacsParser::parseComments(StreamBuffer& in, const std::string str)
         if (ret == l_True) {
             partFile << "s SATISFIABLE" << endl;
             partFile << "v ";
-            for (Var i = 0; i != solver->nVarsReal(); i++) {
+            for (Var i = 0; i != solver->nVarsOutside(); i++) {
                 if (solver->model[i] != l_Undef)
                     partFile
                     << ((solver->model[i]==l_True) ? "" : "-")
@@ -408,7 +408,7 @@ template <class T> void DimacsParser::parse_DIMACS(T input_stream)
     debugLibPart = 1;
     numLearntClauses = 0;
     numNormClauses = 0;
-    const uint32_t origNumVars = solver->nVars();
+    const uint32_t origNumVars = solver->nVarsOutside();
 
     StreamBuffer in(input_stream);
     parse_DIMACS_main(in);
@@ -421,7 +421,7 @@ template <class T> void DimacsParser::parse_DIMACS(T input_stream)
         << " normals "
         << endl;
 
-        cout << "c -- vars added " << std::setw(10) << (solver->nVars() - origNumVars)
+        cout << "c -- vars added " << std::setw(10) << (solver->nVarsOutside() - origNumVars)
         << endl;
     }
 }
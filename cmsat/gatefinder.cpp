@@ -514,9 +514,9 @@ void GateFinder::findOrGate(
             ; wsIt != endWS && !OK
             ; wsIt++
         ) {
-            //Only binary clauses are of importance
+            //Only binary clauses are of importance, they are at the front
             if (!wsIt->isBinary())
-                continue;
+                break;
 
             if ((learntGatesToo || !wsIt->learnt())
                  && wsIt->lit2() == eqLit
@@ -197,9 +197,12 @@ bool ImplCache::clean(Solver* solver)
                 numUpdated++;
             }
 
-            //If updated version is eliminated, skip
-            if (solver->varData[lit.var()].removed != Removed::none)
+            //If updated version is eliminated or set, skip
+            if (solver->varData[lit.var()].removed != Removed::none
+                || solver->value(lit.var()) != l_Undef
+            ) {
                 continue;
+            }
 
             //If we have already visited this var, just skip over, but update nonLearnt
             if (inside[lit.toInt()]) {
@@ -234,6 +237,7 @@ bool ImplCache::clean(Solver* solver)
         numCleaned += origSize-trans->lits.size();
     }
 
+    const size_t origTrailSize = solver->trail.size();
     solver->enqueueThese(toEnqueue);
 
     if (solver->conf.verbosity >= 1) {
@@ -244,6 +248,11 @@ bool ImplCache::clean(Solver* solver)
         << " T: " << std::setprecision(2) << std::fixed  << (cpuTime()-myTime) << endl;
     }
 
+    //The new units are still in the cache. Renumbering moves set vars beyond
+    //nVars(), so they must be cleaned out, too
+    if (solver->okay() && solver->trail.size() != origTrailSize)
+        return clean(solver);
+
     return solver->okay();
 }
 
@@ -421,7 +430,7 @@ void ImplCache::tryVar(
         ; it++
     ) {
         if (!it->isBinary())
-            continue;
+            break;
 
         const Lit otherLit = it->lit2();
 
@@ -461,7 +470,7 @@ void ImplCache::tryVar(
     //Using binary clauses
     for (vec<Watched>::const_iterator it = ws2.begin(), end = ws2.end(); it != end; it++) {
         if (!it->isBinary())
-            continue;
+            break;
 
         assert(it->lit2().var() != var);
         const Var var2 = it->lit2().var();
@@ -482,7 +491,7 @@ void ImplCache::tryVar(
 
     for (vec<Watched>::const_iterator it = ws1.begin(), end = ws1.end(); it != end; it++) {
         if (!it->isBinary())
-            continue;
+            break;
 
         seen[it->lit2().var()] = false;
         val[it->lit2().var()] = false;
@@ -0,0 +1,420 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "localsearch.h"
+#include "clause.h"
+#include "solver.h"
+#include "time_mem.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace CMSat;
+
+const uint32_t LocalSearch::noPos;
+
+LocalSearch::LocalSearch(Solver* _solver) :
+    solver(_solver)
+    , bestNumUnsat(0)
+    , flipsOverflow(false)
+    , bogoProps(0)
+{
+}
+
+void LocalSearch::addClause(const Lit* begin, const Lit* end)
+{
+    const size_t at = clLits.size();
+    for(const Lit* l = begin; l != end; l++) {
+        const lbool val = solver->value(*l);
+        if (val == l_True) {
+            clLits.resize(at);
+            return;
+        }
+
+        if (val == l_Undef) {
+            clLits.push_back(*l);
+        }
+    }
+
+    //Everything is propagated at level 0, so this can't be unit or empty
+    assert(clLits.size() - at >= 2);
+    clStart.push_back(clLits.size());
+}
+
+/**
+@brief Copies the irredundant clauses over, without the level 0 assignments
+*/
+void LocalSearch::init()
+{
+    clLits.clear();
+    clStart.clear();
+    clStart.push_back(0);
+
+    for(vector<ClOffset>::const_iterator
+        it = solver->longIrredCls.begin(), end = solver->longIrredCls.end()
+        ; it != end
+        ; it++
+    ) {
+        const Clause& cl = *solver->clAllocator->getPointer(*it);
+        addClause(cl.begin(), cl.end());
+    }
+
+    Lit lits[3];
+    size_t wsLit = 0;
+    for (vector<vec<Watched> >::const_iterator
+        it = solver->watches.begin(), end = solver->watches.end()
+        ; it != end
+        ; it++, wsLit++
+    ) {
+        const Lit lit = Lit::toLit(wsLit);
+        for (vec<Watched>::const_iterator
+            it2 = it->begin(), end2 = it->end()
+            ; it2 != end2
+            ; it2++
+        ) {
+            //Only irredundant ones, and only once
+            if (it2->isBinary()
+                && !it2->learnt()
+                && lit < it2->lit2()
+            ) {
+                lits[0] = lit;
+                lits[1] = it2->lit2();
+                addClause(lits, lits + 2);
+            }
+
+            if (it2->isTri()
+                && !it2->learnt()
+                && lit < it2->lit2()
+                && it2->lit2() < it2->lit3()
+            ) {
+                lits[0] = lit;
+                lits[1] = it2->lit2();
+                lits[2] = it2->lit3();
+                addClause(lits, lits + 3);
+            }
+        }
+    }
+
+    setupOccurs();
+}
+
+void LocalSearch::setupOccurs()
+{
+    const size_t numLits = solver->nVars()*2;
+    occStart.clear();
+    occStart.resize(numLits + 1, 0);
+    for(vector<Lit>::const_iterator
+        it = clLits.begin(), end = clLits.end()
+        ; it != end
+        ; it++
+    ) {
+        occStart[it->toInt() + 1]++;
+    }
+    for(size_t i = 0; i < numLits; i++) {
+        occStart[i+1] += occStart[i];
+    }
+
+    //Fill, using 'breaks' as the fill pointer of every literal for now
+    occs.resize(clLits.size());
+    vector<uint32_t>& fill = breaks;
+    fill.assign(occStart.begin(), occStart.end() - 1);
+    size_t maxSize = 0;
+    for(size_t i = 0; i + 1 < clStart.size(); i++) {
+        maxSize = std::max<size_t>(maxSize, clStart[i+1] - clStart[i]);
+        for(size_t at = clStart[i]; at < clStart[i+1]; at++) {
+            occs[fill[clLits[at].toInt()]++] = i;
+        }
+    }
+    setupBreakProbs(maxSize);
+}
+
+/**
+@brief ProbSAT with exponential break-only probabilities
+
+The base depends on the clause size, as per Balint&Schoening
+*/
+void LocalSearch::setupBreakProbs(const size_t maxSize)
+{
+    double cb;
+    if (maxSize <= 3) {
+        cb = 2.06;
+    } else if (maxSize == 4) {
+        cb = 3.0;
+    } else if (maxSize == 5) {
+        cb = 3.7;
+    } else if (maxSize == 6) {
+        cb = 5.1;
+    } else {
+        cb = 5.4;
+    }
+
+    breakProb.resize(64);
+    for(size_t i = 0; i < breakProb.size(); i++) {
+        breakProb[i] = std::pow(cb, -(double)i);
+    }
+}
+
+lbool LocalSearch::run()
+{
+    assert(solver->decisionLevel() == 0);
+    assert(solver->ok);
+    const double myTime = cpuTime();
+    runStats.numCalls++;
+
+    init();
+    const size_t numCls = clStart.size() - 1;
+
+    //Start from the saved polarities
+    assign.resize(solver->nVars());
+    for(size_t i = 0; i < solver->nVars(); i++) {
+        assign[i] = solver->varData[i].polarity;
+    }
+
+    numTrue.assign(numCls, 0);
+    trueVarXor.assign(numCls, 0);
+    breaks.assign(solver->nVars(), 0);
+    unsat.clear();
+    unsatPos.assign(numCls, noPos);
+    for(size_t i = 0; i < numCls; i++) {
+        for(size_t at = clStart[i]; at < clStart[i+1]; at++) {
+            const Lit lit = clLits[at];
+            if (assign[lit.var()] != lit.sign()) {
+                numTrue[i]++;
+                trueVarXor[i] ^= lit.var();
+            }
+        }
+
+        if (numTrue[i] == 0) {
+            unsatPos[i] = unsat.size();
+            unsat.push_back(i);
+        } else if (numTrue[i] == 1) {
+            breaks[trueVarXor[i]]++;
+        }
+    }
+    best = assign;
+    bestNumUnsat = unsat.size();
+    flipsSinceBest.clear();
+    flipsOverflow = false;
+
+    //Flip until everything is satisfied or we are out of time
+    bogoProps = clLits.size();
+    const uint64_t maxBogoProps = solver->conf.localSearchMBogo*1000ULL*1000ULL;
+    while (!unsat.empty() && bogoProps < maxBogoProps) {
+        const uint32_t cl = unsat[solver->mtrand.randInt(unsat.size()-1)];
+        flip(pickVar(cl));
+        runStats.numFlips++;
+
+        if (unsat.size() < bestNumUnsat) {
+            saveBest();
+        }
+    }
+
+    lbool ret = l_Undef;
+    if (unsat.empty()) {
+        runStats.numFound++;
+        ret = tryModel();
+        if (ret != l_True) {
+            runStats.numRejected++;
+        }
+    }
+
+    //Continue CDCL from the best assignment
+    if (ret != l_True) {
+        for(size_t i = 0; i < solver->nVars(); i++) {
+            solver->varData[i].polarity = best[i];
+        }
+    }
+
+    runStats.lastBestUnsat = bestNumUnsat;
+    runStats.bogoProps = bogoProps;
+    runStats.cpu_time = cpuTime() - myTime;
+    if (solver->conf.verbosity >= 2) {
+        runStats.printShort();
+    }
+    globalStats += runStats;
+    runStats.clear();
+
+    return ret;
+}
+
+Var LocalSearch::pickVar(const uint32_t cl)
+{
+    const size_t size = clStart[cl+1] - clStart[cl];
+    const Lit* lits = &clLits[clStart[cl]];
+    bogoProps += size;
+
+    probs.resize(size);
+    double sum = 0;
+    for(size_t i = 0; i < size; i++) {
+        const uint32_t b = breaks[lits[i].var()];
+        probs[i] = b < breakProb.size() ? breakProb[b] : 0;
+        sum += probs[i];
+    }
+
+    //Everything breaks a lot, pick randomly
+    if (sum == 0) {
+        return lits[solver->mtrand.randInt(size-1)].var();
+    }
+
+    double r = solver->mtrand.randDblExc(sum);
+    for(size_t i = 0; i + 1 < size; i++) {
+        r -= probs[i];
+        if (r <= 0)
+            return lits[i].var();
+    }
+    return lits[size-1].var();
+}
+
+void LocalSearch::flip(const Var var)
+{
+    assign[var] ^= 1;
+    const Lit nowTrue = Lit(var, !assign[var]);
+
+    //Clauses that get a new true literal
+    const uint32_t* it = &occs[0] + occStart[nowTrue.toInt()];
+    const uint32_t* end = &occs[0] + occStart[nowTrue.toInt() + 1];
+    bogoProps += end - it;
+    for(; it != end; it++) {
+        const uint32_t cl = *it;
+        numTrue[cl]++;
+        if (numTrue[cl] == 1) {
+            //Now satisfied
+            const uint32_t pos = unsatPos[cl];
+            unsat[pos] = unsat.back();
+            unsatPos[unsat[pos]] = pos;
+            unsat.pop_back();
+            unsatPos[cl] = noPos;
+            breaks[var]++;
+        } else if (numTrue[cl] == 2) {
+            //The other one is not critical anymore
+            breaks[trueVarXor[cl]]--;
+        }
+        trueVarXor[cl] ^= var;
+    }
+
+    //Clauses that lose a true literal
+    it = &occs[0] + occStart[(~nowTrue).toInt()];
+    end = &occs[0] + occStart[(~nowTrue).toInt() + 1];
+    bogoProps += end - it;
+    for(; it != end; it++) {
+        const uint32_t cl = *it;
+        numTrue[cl]--;
+        trueVarXor[cl] ^= var;
+        if (numTrue[cl] == 0) {
+            //Now unsatisfied
+            unsatPos[cl] = unsat.size();
+            unsat.push_back(cl);
+            breaks[var]--;
+        } else if (numTrue[cl] == 1) {
+            //The remaining one is now critical
+            breaks[trueVarXor[cl]]++;
+        }
+    }
+
+    if (!flipsOverflow) {
+        flipsSinceBest.push_back(var);
+        if (flipsSinceBest.size() > assign.size()) {
+            flipsOverflow = true;
+            flipsSinceBest.clear();
+        }
+    }
+}
+
+/**
+@brief Makes the current assignment the best one
+
+Only the variables flipped since the last save are copied, unless there were
+more flips than variables
+*/
+void LocalSearch::saveBest()
+{
+    if (flipsOverflow) {
+        best = assign;
+    } else {
+        for(vector<Var>::const_iterator
+            it = flipsSinceBest.begin(), end = flipsSinceBest.end()
+            ; it != end
+            ; it++
+        ) {
+            best[*it] = assign[*it];
+        }
+    }
+    flipsSinceBest.clear();
+    flipsOverflow = false;
+    bestNumUnsat = unsat.size();
+}
+
+/**
+@brief Decides on the satisfying assignment and propagates
+
+Learnt clauses are not checked by the local search, and the caller may have
+assumptions, so the assignment is only accepted if propagation agrees
+*/
+lbool LocalSearch::tryModel()
+{
+    for(size_t i = 0; i < solver->nVars(); i++) {
+        solver->varData[i].polarity = assign[i];
+    }
+
+    if (!solver->assumptions.empty())
+        return l_Undef;
+
+    for(size_t var = 0; var < solver->nVars(); var++) {
+        if (solver->value(var) != l_Undef
+            || solver->varData[var].removed != Removed::none
+        ) {
+            continue;
+        }
+
+        solver->newDecisionLevel();
+        solver->enqueue(Lit(var, !assign[var]));
+        bogoProps += 1;
+        if (!solver->propagate().isNULL()) {
+            solver->cancelUntil(0);
+            return l_Undef;
+        }
+    }
+
+    solver->solution = solver->assigns;
+    solver->cancelUntil(0);
+
+    return l_True;
+}
+
+uint64_t LocalSearch::memUsed() const
+{
+    uint64_t mem = 0;
+    mem += clLits.capacity()*sizeof(Lit);
+    mem += clStart.capacity()*sizeof(uint32_t);
+    mem += numTrue.capacity()*sizeof(uint32_t);
+    mem += trueVarXor.capacity()*sizeof(uint32_t);
+    mem += occStart.capacity()*sizeof(uint32_t);
+    mem += occs.capacity()*sizeof(uint32_t);
+    mem += assign.capacity()*sizeof(char);
+    mem += breaks.capacity()*sizeof(uint32_t);
+    mem += unsat.capacity()*sizeof(uint32_t);
+    mem += unsatPos.capacity()*sizeof(uint32_t);
+    mem += best.capacity()*sizeof(char);
+    mem += flipsSinceBest.capacity()*sizeof(Var);
+    mem += breakProb.capacity()*sizeof(double);
+    mem += probs.capacity()*sizeof(double);
+
+    return mem;
+}
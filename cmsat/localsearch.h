@@ -0,0 +1,204 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __LOCALSEARCH_H__
+#define __LOCALSEARCH_H__
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+class Solver;
+using std::vector;
+using std::cout;
+using std::endl;
+
+/**
+@brief ProbSAT local search on the irredundant clauses
+
+The clauses (long irredundant clauses, plus the irredundant binaries and
+tertiaries from the watchlists) are copied into one flat array, and the
+occurrence lists into another one, indexed by literal. Level 0 assignments are
+taken into account: satisfied clauses are skipped, false literals are left out.
+
+Every clause keeps the number of its true literals and the XOR of the
+variables of its true literals. When only one literal is true, the XOR is the
+variable of that literal, so the break count of every variable can be kept up
+to date incrementally while flipping.
+
+The search starts from the saved polarities. If it satisfies every clause,
+the assignment is tried as decisions on the real solver, and if propagation
+agrees, the solution is returned. Otherwise, the assignment with the fewest
+unsatisfied clauses is written back to the saved polarities.
+*/
+class LocalSearch
+{
+    public:
+        LocalSearch(Solver* solver);
+
+        //Must be called at decision level 0, after propagation
+        lbool run();
+
+        uint64_t memUsed() const;
+
+        struct Stats
+        {
+            Stats() :
+                numCalls(0)
+                , numFound(0)
+                , numRejected(0)
+                , numFlips(0)
+                , bogoProps(0)
+                , lastBestUnsat(0)
+                , cpu_time(0)
+            {}
+
+            void clear()
+            {
+                Stats tmp;
+                *this = tmp;
+            }
+
+            Stats& operator+=(const Stats& other)
+            {
+                numCalls += other.numCalls;
+                numFound += other.numFound;
+                numRejected += other.numRejected;
+                numFlips += other.numFlips;
+                bogoProps += other.bogoProps;
+                lastBestUnsat = other.lastBestUnsat;
+                cpu_time += other.cpu_time;
+
+                return *this;
+            }
+
+            void print() const
+            {
+                cout << "c -------- LOCAL SEARCH STATS --------" << endl;
+                printStatsLine("c calls"
+                    , numCalls
+                );
+                printStatsLine("c found solution"
+                    , numFound
+                    , numRejected
+                    , "rejected by propagation"
+                );
+                printStatsLine("c flips"
+                    , numFlips
+                    , (double)numFlips/cpu_time/1000000.0
+                    , "M/s"
+                );
+                printStatsLine("c Mbogo-props"
+                    , (double)bogoProps/1000000.0
+                );
+                printStatsLine("c last best unsat cls"
+                    , lastBestUnsat
+                );
+                printStatsLine("c time"
+                    , cpu_time
+                    , cpu_time/(double)numCalls
+                    , "per call"
+                );
+                cout << "c -------- LOCAL SEARCH STATS END --------" << endl;
+            }
+
+            void printShort() const
+            {
+                cout
+                << "c [sls]"
+                << " flips: " << numFlips
+                << " best unsat: " << lastBestUnsat
+                << " found: " << numFound
+                << " T: " << std::fixed << std::setprecision(2)
+                << cpu_time << " s"
+                << endl;
+            }
+
+            uint64_t numCalls;
+            uint64_t numFound;
+            uint64_t numRejected;
+            uint64_t numFlips;
+            uint64_t bogoProps;
+            uint64_t lastBestUnsat;
+            double cpu_time;
+        };
+
+        const Stats& getStats() const;
+
+    private:
+        Solver* solver;
+
+        //Setup
+        void init();
+        void addClause(const Lit* begin, const Lit* end);
+        void setupOccurs();
+        void setupBreakProbs(const size_t maxSize);
+
+        //Search
+        void flip(const Var var);
+        Var  pickVar(const uint32_t cl);
+        void saveBest();
+        lbool tryModel();
+        static const uint32_t noPos = std::numeric_limits<uint32_t>::max();
+
+        //Clauses, flat
+        vector<Lit>      clLits;
+        vector<uint32_t> clStart; ///<Clause i is clLits[clStart[i]...clStart[i+1]-1]
+        vector<uint32_t> numTrue;
+        vector<uint32_t> trueVarXor;
+
+        //Occurrences, flat
+        vector<uint32_t> occStart; ///<Occurrences of lit are occs[occStart[lit]...occStart[lit+1]-1]
+        vector<uint32_t> occs;
+
+        //Assignment
+        vector<char>     assign;
+        vector<uint32_t> breaks;
+        vector<uint32_t> unsat;
+        vector<uint32_t> unsatPos; ///<Position of clause in 'unsat', or noPos
+
+        //Best assignment, lazily updated from the flips since it was saved
+        vector<char>     best;
+        size_t           bestNumUnsat;
+        vector<Var>      flipsSinceBest;
+        bool             flipsOverflow;
+
+        //Picking
+        vector<double>   breakProb;
+        vector<double>   probs;
+
+        uint64_t bogoProps;
+        Stats runStats;
+        Stats globalStats;
+};
+
+inline const LocalSearch::Stats& LocalSearch::getStats() const
+{
+    return globalStats;
+}
+
+} //end namespace
+
+#endif //__LOCALSEARCH_H__
@@ -39,6 +39,9 @@
 #include "constants.h"
 #include "dimacsparser.h"
 #include "solver.h"
+#include "shareddata.h"
+#include "backbone.h"
+#include <thread>
 
 
 #include <boost/lexical_cast.hpp>
@@ -67,6 +70,8 @@ Main::Main(int _argc, char** _argv) :
         , debugNewVar (false)
         , printResult (true)
         , max_nr_of_solutions (1)
+        , doBackbone (false)
+        , numPortfolio (1)
         , fileNamePresent (false)
         , argc(_argc)
         , argv(_argv)
@@ -227,7 +232,7 @@ void Main::printResultFunc(
     if (ret == l_True && (printResult || toFile)) {
 
         if(!toFile) *os << "v ";
-        for (Var var = 0; var != solver->nVarsReal(); var++) {
+        for (Var var = 0; var != solver->nVarsOutside(); var++) {
             if (solver->model[var] != l_Undef)
                 *os << ((solver->model[var] == l_True)? "" : "-") << var+1 << " ";
         }
@@ -284,8 +289,8 @@ void Main::parseCommandLine()
     ("input", po::value< vector<string> >(), "file(s) to read")
     ("random,r", po::value<uint32_t>(&conf.origSeed)->default_value(conf.origSeed)
         , "[0..] Sets random seed")
-    ("threads,t", po::value<int>(&numThreads)->default_value(1)
-        , "Number of threads to use")
+    ("threads,t", po::value<int>(&conf.numThreads)->default_value(conf.numThreads)
+        , "Number of threads to use for parallel inprocessing tasks")
     ("maxtime", po::value<double>(&conf.maxTime)->default_value(conf.maxTime)
         , "Stop solving after this much time, print stats and exit")
     ("maxconfl", po::value<uint64_t>(&conf.maxConfl)->default_value(conf.maxConfl)
@@ -323,13 +328,23 @@ void Main::parseCommandLine()
     ("agilg", po::value<double>(&conf.agilityG)->default_value(conf.agilityG, ssAgilG.str())
         , "See paper by Armin Biere on agilities")
     ("restart", po::value<string>()
-        , "{geom, agility, glue, glueagility}  Restart strategy to follow.")
+        , "{geom, agility, glue, glueagility, ema, luby, switch}  Restart strategy to follow. 'switch' alternates between focused mode with 'ema' restarts and stable mode with 'luby' restarts and target polarities")
     ("agillim", po::value<double>(&conf.agilityLimit)->default_value(conf.agilityLimit, ssAgilL.str())
         , "The agility below which the agility is considered too low")
     ("agilviollim", po::value<uint64_t>(&conf.agilityViolationLimit)->default_value(conf.agilityViolationLimit)
         , "Number of agility limit violations over which to demand a restart")
     ("gluehist", po::value<uint32_t>(&conf.shortTermHistorySize)->default_value(conf.shortTermHistorySize)
         , "The size of the moving window for short-term glue history of learnt clauses. If higher, the minimal number of conflicts between restarts is longer")
+    ("emamargin", po::value<double>(&conf.emaRestartMargin)->default_value(conf.emaRestartMargin)
+        , "EMA restarts restart if the fast glue average is this much above the slow one")
+    ("lubyunit", po::value<uint64_t>(&conf.lubyUnit)->default_value(conf.lubyUnit)
+        , "Luby restarts are this many conflicts times the Luby sequence")
+    ("modefirst", po::value<uint64_t>(&conf.modeSwitchFirst)->default_value(conf.modeSwitchFirst)
+        , "With '--restart switch', conflicts of the first focused phase. Later phases are measured in the propagations this took")
+    ("modeinc", po::value<double>(&conf.modeSwitchInc)->default_value(conf.modeSwitchInc)
+        , "With '--restart switch', multiply the length of phases by this after every stable phase")
+    ("rephaseint", po::value<uint64_t>(&conf.rephaseInterval)->default_value(conf.rephaseInterval)
+        , "In stable mode, rephase every N*this conflicts, where N is the number of rephases so far")
     ;
 
     po::options_description reduceDBOptions("Learnt clause removal options");
@@ -352,6 +367,16 @@ void Main::parseCommandLine()
         , "Clean increment cleaning by this factor for next cleaning")
     ("maxredratio", po::value<double>(&conf.maxNumLearntsRatio)->default_value(conf.maxNumLearntsRatio)
         , "Don't ever have more than maxNumLearntsRatio*(irred_clauses) redundant clauses")
+    ("gluecore", po::value<uint32_t>(&conf.glueCoreMax)->default_value(conf.glueCoreMax)
+        , "Learnt clauses with at most this glue are never removed")
+    ("gluetier2", po::value<uint32_t>(&conf.glueTier2Max)->default_value(conf.glueTier2Max)
+        , "Learnt clauses with at most this glue are only removed if they haven't been used since the last cleaning")
+    ("spill", po::value<int>(&conf.doSpillLearnts)->default_value(conf.doSpillLearnts)
+        , "Write removed tier2 learnt clauses to a temporary spill file, and load them back when their variables become active")
+    ("spillmaxmb", po::value<uint64_t>(&conf.spillMaxMB)->default_value(conf.spillMaxMB)
+        , "Maximum size of the spill file in MB")
+    ("spillactive", po::value<double>(&conf.spillActiveRatio)->default_value(conf.spillActiveRatio)
+        , "Reload spilled clauses when most of their variables are in this top ratio of variable activities")
     ;
 
     po::options_description varPickOptions("Variable branching options");
@@ -379,6 +404,8 @@ void Main::parseCommandLine()
     iterativeOptions.add_options()
     ("maxsol", po::value<uint32_t>(&max_nr_of_solutions)->default_value(max_nr_of_solutions)
         , "Search for given amount of solutions")
+    ("backbone", po::value<int>(&doBackbone)->default_value(doBackbone)
+        , "Compute the backbone (the literals TRUE in every solution) and print it instead of a solution")
     ("dumplearnts", po::value<string>(&conf.learntsDumpFilename)
         , "If stopped dump learnt clauses here")
     ("maxdump", po::value<uint32_t>(&conf.maxDumpLearntsSize)
@@ -428,6 +455,14 @@ void Main::parseCommandLine()
         , "No extended subsumption with binary clauses")
     ("eratio", po::value<double>(&conf.varElimRatioPerIter)->default_value(conf.varElimRatioPerIter, ssERatio.str())
         , "Eliminate this ratio of free variables at most per variable elimination iteration")
+    ("elimgates", po::value<int>(&conf.doGateElim)->default_value(conf.doGateElim)
+        , "When eliminating a variable defined by an AND/OR/XOR gate, only resolve gate clauses with non-gate clauses")
+    ("bva", po::value<int>(&conf.doBva)->default_value(conf.doBva)
+        , "Do bounded variable addition, re-encoding clause patterns with new variables")
+    ("bvalimit", po::value<uint64_t>(&conf.bvaLimitM)->default_value(conf.bvaLimitM)
+        , "Time limit of bounded variable addition, in millions of bogoprops")
+    ("bvamingain", po::value<int>(&conf.bvaMinGain)->default_value(conf.bvaMinGain)
+        , "Only add a new variable if it saves at least this many clauses")
     ("occlearntmax", po::value<unsigned>(&conf.maxRedLinkInSize)->default_value(conf.maxRedLinkInSize)
         , "Don't add to occur list any learnt clause larger than this")
     ;
@@ -435,6 +470,40 @@ void Main::parseCommandLine()
     std::ostringstream sccFindPercent;
     sccFindPercent << std::fixed << std::setprecision(3) << conf.sccFindPercent;
 
+    po::options_description localSearchOptions("Local search options");
+    localSearchOptions.add_options()
+    ("sls", po::value<int>(&conf.doLocalSearch)->default_value(conf.doLocalSearch)
+        , "Run ProbSAT local search after every simplification. Solves the problem if it finds a solution, otherwise sets the polarities")
+    ("slsmbogo", po::value<uint64_t>(&conf.localSearchMBogo)->default_value(conf.localSearchMBogo)
+        , "Budget of one local search run, in millions of bogoprops")
+    ;
+
+    po::options_description cardOptions("At-most-one constraint options");
+    cardOptions.add_options()
+    ("cards", po::value<int>(&conf.doFindCards)->default_value(conf.doFindCards)
+        , "Find at-most-one constraints encoded with binary clauses, and propagate them natively during search")
+    ("cardmin", po::value<uint32_t>(&conf.cardMinSize)->default_value(conf.cardMinSize)
+        , "Only treat at-most-one constraints natively with at least this many literals")
+    ("cardrembins", po::value<int>(&conf.doCardRemBins)->default_value(conf.doCardRemBins)
+        , "Remove the binary clauses of the native at-most-one constraints during search")
+    ("cardlimit", po::value<uint64_t>(&conf.cardFindLimitM)->default_value(conf.cardFindLimitM)
+        , "Time limit of finding at-most-one constraints, in millions of bogoprops")
+    ;
+
+    po::options_description sweepOptions("SAT sweeping options");
+    sweepOptions.add_options()
+    ("sweep", po::value<int>(&conf.doSweep)->default_value(conf.doSweep)
+        , "Find equivalent literals of OR/AND gates through random simulation and budgeted SAT calls")
+    ("sweepwords", po::value<uint32_t>(&conf.sweepSimWords)->default_value(conf.sweepSimWords)
+        , "Simulate the gates with this many times 64 random patterns")
+    ("sweepconfl", po::value<uint64_t>(&conf.sweepConflPerCall)->default_value(conf.sweepConflPerCall)
+        , "Conflict budget of one SAT call proving an equivalence")
+    ("sweeplimit", po::value<uint64_t>(&conf.sweepLimitM)->default_value(conf.sweepLimitM)
+        , "Budget of all SAT calls of one sweep, in millions of bogoprops")
+    ("sweepfindlimit", po::value<uint64_t>(&conf.sweepFindLimitM)->default_value(conf.sweepFindLimitM)
+        , "Time limit of extracting the gates, in millions of bogoprops")
+    ;
+
     po::options_description xorOptions("XOR-related options");
     xorOptions.add_options()
     ("xor", po::value<int>(&conf.doFindXors)->default_value(conf.doFindXors)
@@ -565,10 +634,16 @@ void Main::parseCommandLine()
     //("noparts", "Don't find&solve subproblems with subsolvers")
     ("vivif", po::value<int>(&conf.doClausVivif)->default_value(conf.doClausVivif)
         , "Regularly execute clause vivification")
+    ("vivifred", po::value<int>(&conf.doVivifLearnt)->default_value(conf.doVivifLearnt)
+        , "Vivify the low-glue learnt clauses during search, after every learnt clause cleaning")
+    ("vivifredprops", po::value<uint64_t>(&conf.vivifLearntPropsPerConfl)->default_value(conf.vivifLearntPropsPerConfl)
+        , "Budget of learnt clause vivification, in bogoprops per conflict since the last one")
     ("sortwatched", po::value<int>(&conf.doSortWatched)->default_value(conf.doSortWatched)
         , "Sort watches according to size")
     ("renumber", po::value<int>(&conf.doRenumberVars)->default_value(conf.doRenumberVars)
         , "Renumber variables to increase CPU cache efficiency")
+    ("renumberlocal", po::value<int>(&conf.doRenumberLocality)->default_value(conf.doRenumberLocality)
+        , "When renumbering, order the variables by breadth-first search over the irredundant clauses")
     ("savemem", po::value<int>(&conf.doSaveMem)->default_value(conf.doSaveMem)
         , "Save memory by deallocating variable space after renumbering. Only works if renumbering is active.")
     ("implicitmanip", po::value<int>(&conf.doStrSubImplicit)->default_value(conf.doStrSubImplicit)
@@ -584,9 +659,16 @@ void Main::parseCommandLine()
     ("compsfrom", po::value<uint64_t>(&conf.handlerFromSimpNum)->default_value(conf.handlerFromSimpNum)
         , "Component finding only after this many simplification rounds")
     ("compsvar", po::value<uint64_t>(&conf.compVarLimit)->default_value(conf.compVarLimit)
-        , "Only use components in case the number of variables is below this limit")
-    ("compslimit", po::value<uint64_t>(&conf.compFindLimitMega)->default_value(conf.compFindLimitMega)
-        , "Limit how much time is spent in component-finding");
+        , "Only use components in case the number of variables is below this limit");
+
+    po::options_description portfolioOptions("Portfolio options");
+    portfolioOptions.add_options()
+    ("portfolio", po::value<uint32_t>(&numPortfolio)->default_value(numPortfolio)
+        , "Run this many differently configured solvers in parallel, exchanging learnt units and binaries")
+    ("det", po::value<int>(&conf.doDeterministic)->default_value(conf.doDeterministic)
+        , "Exchange clauses at fixed conflict counts, so result and stats don't depend on thread timing")
+    ("syncconfl", po::value<uint64_t>(&conf.syncEveryConfl)->default_value(conf.syncEveryConfl)
+        , "Exchange learnt clauses every this many conflicts");
 
     po::positional_options_description p;
     p.add("input", 1);
@@ -610,6 +692,10 @@ void Main::parseCommandLine()
     .add(simplificationOptions)
     .add(eqLitOpts)
     .add(componentOptions)
+    .add(portfolioOptions)
+    .add(localSearchOptions)
+    .add(cardOptions)
+    .add(sweepOptions)
     #ifdef USE_M4RI
     .add(xorOptions)
     #endif
@@ -819,14 +905,38 @@ void Main::parseCommandLine()
             conf.restartType = Restart::agility;
         else if (type == "glueagility")
             conf.restartType = Restart::glue_agility;
+        else if (type == "ema")
+            conf.restartType = Restart::glue_ema;
+        else if (type == "luby")
+            conf.restartType = Restart::luby;
+        else if (type == "switch")
+            conf.restartType = Restart::modeswitch;
         else throw WrongParam("restart", "unknown restart type");
     }
 
-    if (numThreads < 1)
+    if (conf.numThreads < 1)
         throw WrongParam("threads", "Num threads must be at least 1");
 
-    if (numThreads > 1)
-        throw WrongParam("threads", "Currently, more than 1 thread is not supported. Sorry!");
+    if (conf.glueCoreMax > conf.glueTier2Max)
+        throw WrongParam("gluecore", "Core glue limit cannot be above the tier2 glue limit");
+
+    if (conf.spillActiveRatio <= 0 || conf.spillActiveRatio > 1)
+        throw WrongParam("spillactive", "Ratio of active variables must be in (0, 1]");
+
+    if (numPortfolio < 1)
+        throw WrongParam("portfolio", "Portfolio must have at least 1 solver");
+
+    if (numPortfolio > 1 && max_nr_of_solutions > 1)
+        throw WrongParam("portfolio", "Portfolio solving cannot find multiple solutions");
+
+    if (numPortfolio > 1 && conf.syncEveryConfl == 0)
+        throw WrongParam("syncconfl", "Clauses must be exchanged every 1 or more conflicts");
+
+    if (doBackbone && numPortfolio > 1)
+        throw WrongParam("backbone", "Backbone cannot be computed with portfolio solving");
+
+    if (doBackbone && max_nr_of_solutions > 1)
+        throw WrongParam("backbone", "Backbone cannot be computed while searching for multiple solutions");
 
 
     //If the number of solutions requested is more than 1, we need to disable blocking
@@ -839,6 +949,18 @@ void Main::parseCommandLine()
         }
     }
 
+    //Assumptions are not honoured on removed variables
+    if (doBackbone) {
+        conf.doBlockClauses = false;
+        conf.doVarElim = false;
+        conf.doCompHandler = false;
+        if (conf.verbosity >= 1) {
+            cout
+            << "c Blocking, var-elim and component handling disabled because the backbone is needed"
+            << endl;
+        }
+    }
+
     if (vm.count("input")) {
         filesToRead = vm["input"].as<vector<string> >();
         fileNamePresent = true;
@@ -846,6 +968,10 @@ void Main::parseCommandLine()
         fileNamePresent = false;
     }
 
+    //Every solver of the portfolio reads the input
+    if (numPortfolio > 1 && !fileNamePresent)
+        throw WrongParam("portfolio", "Portfolio solving cannot read from standard input");
+
     #ifdef DRUP
     if (vm.count("drup")) {
         if (drupDebug) {
@@ -903,6 +1029,19 @@ void Main::parseCommandLine()
         conf.doRenumberVars = false;
     }
 
+    if (conf.doSpillLearnts && drupf) {
+        if (conf.verbosity >= 2) {
+            cout
+            << "c Spilling learnt clauses is not supported during DRUP, turning it off"
+            << endl;
+        }
+        conf.doSpillLearnts = false;
+    }
+
+    if (numPortfolio > 1 && drupf) {
+        throw WrongParam("portfolio", "Imported clauses cannot be proven in DRUP");
+    }
+
     if (conf.doCompHandler && drupf) {
         if (conf.verbosity >= 2) {
             cout
@@ -933,9 +1072,95 @@ void Main::printVersionInfo()
     #endif
 }
 
+/**
+@brief Configuration of portfolio solver "num". Solver 0 is as configured
+*/
+SolverConf Main::portfolioConf(const size_t num) const
+{
+    SolverConf thisConf = conf;
+    if (num == 0)
+        return thisConf;
+
+    //Only the first one prints
+    thisConf.verbosity = 0;
+    thisConf.origSeed = conf.origSeed + num;
+    thisConf.random_var_freq = 0.005*(double)num;
+    switch (num % 3) {
+        case 1:
+            thisConf.restartType = Restart::geom;
+            break;
+        case 2:
+            thisConf.restartType = Restart::glue;
+            break;
+        default:
+            thisConf.polarity_mode = PolarityMode::rnd;
+            break;
+    }
+
+    return thisConf;
+}
+
+/**
+@brief Solves with all solvers in parallel, and sets "solver" to the winner
+*/
+lbool Main::solvePortfolio(vector<Solver*>& solvers)
+{
+    SharedData shared(solvers.size(), conf.doDeterministic);
+    for(size_t i = 0; i < solvers.size(); i++) {
+        solvers[i]->setSharedData(&shared, i);
+    }
+
+    const double myTime = realTimeSec();
+    vector<lbool> rets(solvers.size(), l_Undef);
+    vector<std::thread> threads;
+    for(size_t i = 0; i < solvers.size(); i++) {
+        threads.push_back(std::thread([&, i]() {
+            rets[i] = solvers[i]->solve();
+            shared.finished(i, rets[i]);
+        }));
+    }
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    const double wallTime = realTimeSec() - myTime;
+
+    const size_t winner = shared.getWinner();
+    if (conf.verbosity >= 1) {
+        uint64_t sumConfl = 0;
+        for(size_t i = 0; i < solvers.size(); i++) {
+            sumConfl += solvers[i]->sumConflicts();
+        }
+
+        printStatsLine("c portfolio winner"
+            , winner
+        );
+        printStatsLine("c portfolio wall time"
+            , wallTime
+        );
+        printStatsLine("c portfolio conflicts"
+            , sumConfl
+            , (double)sumConfl/wallTime
+            , "confl/wall-sec"
+        );
+        shared.printStats();
+    }
+
+    solver = solvers[winner];
+    solverToInterrupt = solver;
+    for(size_t i = 0; i < solvers.size(); i++) {
+        solvers[i]->setSharedData(NULL, i);
+    }
+
+    return rets[winner];
+}
+
 int Main::solve()
 {
-    solver = new Solver(conf);
+    vector<Solver*> solvers;
+    for(size_t i = 0; i < numPortfolio; i++) {
+        solvers.push_back(new Solver(portfolioConf(i)));
+    }
+    solver = solvers[0];
     solverToInterrupt = solver;
     #ifdef DRUP
     solver->drup = drupf;
@@ -966,13 +1191,38 @@ int Main::solve()
     }
 
     //Parse in DIMACS (maybe gzipped) files
-    parseInAllFiles();
+    for(size_t i = 0; i < solvers.size(); i++) {
+        solver = solvers[i];
+        parseInAllFiles();
+    }
+    solver = solvers[0];
 
-    //Multi-solutions
     unsigned long current_nr_of_solutions = 0;
     lbool ret = l_True;
-    while(current_nr_of_solutions < max_nr_of_solutions && ret == l_True) {
-        ret = solver->solve();
+
+    //Backbone, printed on the "v" line in place of the solution
+    Backbone backbone(solver);
+    if (doBackbone) {
+        ret = backbone.extract();
+        if (ret == l_True) {
+            std::fill(solver->model.begin(), solver->model.end(), l_Undef);
+            for(const Lit lit: backbone.getBackbone()) {
+                solver->model[lit.var()] = lit.sign() ? l_False : l_True;
+            }
+        }
+        current_nr_of_solutions++;
+    }
+
+    //Multi-solutions
+    while(!doBackbone
+        && current_nr_of_solutions < max_nr_of_solutions
+        && ret == l_True
+    ) {
+        if (solvers.size() > 1) {
+            ret = solvePortfolio(solvers);
+        } else {
+            ret = solver->solve();
+        }
         current_nr_of_solutions++;
 
         if (ret == l_True && current_nr_of_solutions < max_nr_of_solutions) {
@@ -994,7 +1244,7 @@ int Main::solve()
 
             //Banning found solution
             vector<Lit> lits;
-            for (Var var = 0; var < solver->nVars(); var++) {
+            for (Var var = 0; var < solver->nVarsOutside(); var++) {
                 if (solver->model[var] != l_Undef) {
                     lits.push_back( Lit(var, (solver->model[var] == l_True)? true : false) );
                 }
@@ -1012,6 +1262,8 @@ int Main::solve()
     }
     if (conf.verbosity >= 1) {
         solver->printStats();
+        if (doBackbone)
+            backbone.getStats().print();
     }
 
     //Final print of solution
@@ -1020,8 +1272,10 @@ int Main::solve()
         printResultFunc(&resultfile, true, ret, current_nr_of_solutions == 1);
     }
 
-    //Delete solver
-    delete solver;
+    //Delete solvers
+    for(size_t i = 0; i < solvers.size(); i++) {
+        delete solvers[i];
+    }
     solver = NULL;
 
     #ifdef DRUP
@@ -64,9 +64,12 @@ class Main
         void printVersionInfo();
         int correctReturnValue(const CMSat::lbool ret) const;
 
+        //Portfolio
+        CMSat::lbool solvePortfolio(vector<CMSat::Solver*>& solvers);
+        CMSat::SolverConf portfolioConf(const size_t num) const;
+
         //Config
         CMSat::SolverConf conf;
-        int numThreads;
         bool debugLib;
         bool debugNewVar;
         int printResult;
@@ -75,6 +78,12 @@ class Main
         //Multi-start solving
         uint32_t max_nr_of_solutions;
 
+        //Backbone extraction
+        int doBackbone;
+
+        //Parallel solving
+        uint32_t numPortfolio;
+
         //Files to read & write
         bool fileNamePresent;
         vector<string> filesToRead;
@@ -102,7 +102,7 @@ void Prober::checkOTFRatio()
     }
 }
 
-bool Prober::probe()
+bool Prober::probe(const vector<Var>* onlyVars)
 {
     assert(solver->decisionLevel() == 0);
     assert(solver->nVars() > 0);
@@ -212,12 +212,14 @@ bool Prober::probe()
 
     //Calculate the set of possible variables for branching on randomly
     vector<Var> possCh;
-    for(size_t i = 0; i < solver->nVars(); i++) {
-        if (solver->value(i) == l_Undef
-            && (solver->varData[i].removed == Removed::none
-                || solver->varData[i].removed == Removed::queued_replacer)
+    const size_t numToCheck = (onlyVars == NULL) ? solver->nVars() : onlyVars->size();
+    for(size_t i = 0; i < numToCheck; i++) {
+        const Var var = (onlyVars == NULL) ? i : (*onlyVars)[i];
+        if (solver->value(var) == l_Undef
+            && (solver->varData[var].removed == Removed::none
+                || solver->varData[var].removed == Removed::queued_replacer)
         ) {
-            possCh.push_back(i);
+            possCh.push_back(var);
         }
     }
 
@@ -278,8 +280,9 @@ bool Prober::probe()
                     //Update lit
                     lit = betterlit;
 
-                    //Blacklist new lit
-                    possCh[lookup[lit.var()]] = std::numeric_limits<Var>::max();
+                    //Blacklist new lit (it may not be among the vars to probe)
+                    if (lookup[lit.var()] != std::numeric_limits<size_t>::max())
+                        possCh[lookup[lit.var()]] = std::numeric_limits<Var>::max();
 
                     //Must not have visited it already, otherwise the stamp dominator would be incorrect
                     assert(!visitedAlready[lit.toInt()]);
@@ -61,7 +61,8 @@ class Prober {
     public:
         Prober(Solver* _solver);
 
-        bool probe();
+        //If 'onlyVars' is given, only those (internal) vars are probed
+        bool probe(const vector<Var>* onlyVars = NULL);
 
         struct Stats
         {
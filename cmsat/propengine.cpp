@@ -170,8 +170,8 @@ void PropEngine::attachBinClause(
             || varData[lit2.var()].removed == Removed::queued_replacer);
     #endif //DEBUG_ATTACH
 
-    watches[lit1.toInt()].push(Watched(lit2, learnt));
-    watches[lit2.toInt()].push(Watched(lit1, learnt));
+    pushWBin(watches[lit1.toInt()], Watched(lit2, learnt));
+    pushWBin(watches[lit2.toInt()], Watched(lit1, learnt));
 }
 
 /**
@@ -263,6 +263,87 @@ inline bool PropEngine::propBinaryClause(
 }
 
 
+/**
+@brief Propagates the at-most-one constraints containing 'p'
+
+Every other literal of the constraint must be FALSE. This is exactly what the
+binary clauses (~p V ~lit) would do, and their reasons and conflicts are
+given as such binary clauses, so analyze() needs no special handling
+*/
+inline bool PropEngine::propCards(
+    const Lit p
+    , PropBy& confl
+) {
+    for(uint32_t at = cardOccStart[p.toInt()]
+        ; at < cardOccStart[p.toInt()+1]
+        ; at++
+    ) {
+        const uint32_t card = cardOccs[at];
+        const Lit* lit = &cardLits[cardStart[card]];
+        const Lit* end = &cardLits[0] + cardStart[card+1];
+        propStats.bogoProps += (end-lit)/4 + 1;
+        for(; lit != end; lit++) {
+            if (*lit == p)
+                continue;
+
+            const lbool val = value(*lit);
+            if (val == l_Undef) {
+                enqueue(~*lit, PropBy(~p));
+            } else if (val == l_True) {
+                lastConflictCausedBy = ConflCausedBy::binirred;
+                confl = PropBy(~p);
+                failBinLit = ~*lit;
+                qhead = trail.size();
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+@brief Like propCards(), but for propagateFullBFS()
+
+The implied binaries don't exist in the watchlists, so the propagations are
+marked as coming from hyper-binary clauses that were never added. This way,
+transitive reduction never tries to remove them.
+*/
+PropResult PropEngine::propCardsFull(
+    const Lit p
+    , PropBy& confl
+) {
+    PropResult ret = PROP_NOTHING;
+    for(uint32_t at = cardOccStart[p.toInt()]
+        ; at < cardOccStart[p.toInt()+1]
+        ; at++
+    ) {
+        const uint32_t card = cardOccs[at];
+        const Lit* lit = &cardLits[cardStart[card]];
+        const Lit* end = &cardLits[0] + cardStart[card+1];
+        propStats.bogoProps += (end-lit)*4;
+        for(; lit != end; lit++) {
+            if (*lit == p)
+                continue;
+
+            const lbool val = value(*lit);
+            if (val == l_Undef) {
+                enqueueComplex(~*lit, p, false);
+                varData[lit->var()].reason.setHyperbin(true);
+                varData[lit->var()].reason.setHyperbinNotAdded(true);
+                ret = PROP_SOMETHING;
+            } else if (val == l_True) {
+                lastConflictCausedBy = ConflCausedBy::binirred;
+                confl = PropBy(~p);
+                failBinLit = ~*lit;
+                return PROP_FAIL;
+            }
+        }
+    }
+
+    return ret;
+}
+
 /**
 @brief Propagates a normal (n-long where n > 3) clause
 
@@ -772,6 +853,10 @@ PropBy PropEngine::propagateAnyOrder()
         }
         ws.shrink_(end-j);
 
+        if (confl.isNULL() && !cardOccs.empty()) {
+            propCards(p, confl);
+        }
+
         qhead++;
     }
 
@@ -810,17 +895,21 @@ PropBy PropEngine::propagateBinFirst(
         vec<Watched>::const_iterator i = ws.begin();
         const vec<Watched>::const_iterator end = ws.end();
         propStats.bogoProps += ws.size()/10 + 1;
-        for (; i != end; i++) {
 
-            //Propagate binary clause
-            if (i->isBinary()) {
-                if (!propBinaryClause(i, p, confl)) {
-                    break;
-                }
-
-                continue;
+        //Binaries are at the front
+        for (; i != end && i->isBinary(); i++) {
+            if (!propBinaryClause(i, p, confl)) {
+                break;
             }
+        }
+        if (!confl.isNULL())
+            break;
+
+        //At-most-one constraints are binaries, too
+        if (!cardOccs.empty() && !propCards(p, confl))
+            break;
 
+        for (; i != end; i++) {
             //Pre-fetch long clause
             if (i->isClause()) {
                 if (value(i->getBlockedLit()) != l_True) {
@@ -843,13 +932,14 @@ PropBy PropEngine::propagateBinFirst(
         vec<Watched>::iterator j = ws.begin();
         const vec<Watched>::iterator end = ws.end();
         propStats.bogoProps += ws.size()/4 + 1;
-        for (; i != end; i++) {
-            //Skip binary clauses
-            if (i->isBinary()) {
-                *j++ = *i;
-                continue;
-            }
 
+        //Skip binary clauses, they are at the front and stay where they are
+        while (i != end && i->isBinary()) {
+            i++;
+        }
+        j = i;
+
+        for (; i != end; i++) {
             if (i->isTri()) {
                 *j++ = *i;
                 //Propagate tri clause
@@ -906,8 +996,12 @@ PropBy PropEngine::propagateNonLearntBin()
         vec<Watched> & ws = watches[(~p).toInt()];
         for(vec<Watched>::iterator k = ws.begin(), end = ws.end(); k != end; k++) {
 
-            //If not binary, or is learnt, skip
-            if (!k->isBinary() || k->learnt())
+            //Binaries are at the front
+            if (!k->isBinary())
+                break;
+
+            //If learnt, skip
+            if (k->learnt())
                 continue;
 
             //Propagate, if conflict, exit
@@ -962,8 +1056,12 @@ Lit PropEngine::propagateFullBFS(const uint64_t timeout)
         propStats.bogoProps += 1;
         for(vec<Watched>::const_iterator k = ws.begin(), end = ws.end(); k != end; k++) {
 
-            //If something other than non-learnt binary, skip
-            if (!k->isBinary() || k->learnt())
+            //Binaries are at the front
+            if (!k->isBinary())
+                break;
+
+            //If learnt, skip
+            if (k->learnt())
                 continue;
 
             ret = propBin(p, k, confl);
@@ -972,6 +1070,13 @@ Lit PropEngine::propagateFullBFS(const uint64_t timeout)
 
         }
         propStats.bogoProps += ws.size()*4;
+
+        //At-most-one constraints are non-learnt binaries, too
+        if (!cardOccs.empty()
+            && propCardsFull(p, confl) == PROP_FAIL
+        ) {
+            return analyzeFail(confl);
+        }
     }
 
     //Propagate binary learnt
@@ -984,8 +1089,12 @@ Lit PropEngine::propagateFullBFS(const uint64_t timeout)
 
         for(vec<Watched>::const_iterator k = ws.begin(), end = ws.end(); k != end; k++, done++) {
 
-            //If something other than learnt binary, skip
-            if (!k->isBinary() || !k->learnt())
+            //Binaries are at the front
+            if (!k->isBinary())
+                break;
+
+            //If non-learnt, skip
+            if (!k->learnt())
                 continue;
 
             ret = propBin(p, k, confl);
@@ -1076,6 +1185,9 @@ Lit PropEngine::propagateFullDFS(
     assert(uselessBin.empty());
     assert(decisionLevel() == 1);
 
+    //Only used by probing, when the at-most-one constraints are binary clauses
+    assert(cardOccs.empty());
+
     //The toplevel decision has to be set specifically
     //If we came here as part of a backtrack to decision level 1, then
     //this is already set, and there is no need to set it
@@ -1209,8 +1321,12 @@ Lit PropEngine::propagateFullDFS(
             ) {
                 propStats.bogoProps += 1;
 
-                //If something other than learnt binary, skip
-                if (!k->isBinary() || !k->learnt())
+                //Binaries are at the front
+                if (!k->isBinary())
+                    break;
+
+                //If non-learnt, skip
+                if (!k->learnt())
                     continue;
 
                 ret = propBin(p, k, confl);
@@ -166,6 +166,8 @@ struct VarData
         , reason(PropBy())
         , removed(Removed::none)
         , polarity(false)
+        , targetPolarity(l_Undef)
+        , bestPolarity(l_Undef)
     {}
 
     ///contains the decision level at which the assignment was made.
@@ -183,6 +185,14 @@ struct VarData
     ///The preferred polarity of each variable.
     bool polarity;
 
+    ///Value in the longest conflict-free trail since the last rephase. Used
+    ///instead of the preferred polarity in stable mode, if set
+    lbool targetPolarity;
+
+    ///Value in the longest conflict-free trail since the last rephase to the
+    ///best polarities
+    lbool bestPolarity;
+
     #ifdef STATS_NEEDED
     Stats stats;
     #endif
@@ -267,6 +277,7 @@ protected:
 
     //Non-categorised functions
     void     cancelZeroLight(); ///<Backtrack until level 0, without updating agility, etc.
+    void     cancelUntilLight(const uint32_t level); ///<Backtrack until level, without saving polarities, etc.
     template<class T> uint16_t calcGlue(const T& ps); ///<Calculates the glue of a clause
     bool updateGlues;
     bool doLHBR;
@@ -414,6 +425,21 @@ protected:
         , vec<Watched>::const_iterator k
         , PropBy& confl
     );
+
+    ///Native at-most-one constraints, set up by CardFinder for the duration
+    ///of the search. Constraint i is cardLits[cardStart[i]...cardStart[i+1]-1],
+    ///the constraints containing 'lit' are
+    ///cardOccs[cardOccStart[lit]...cardOccStart[lit+1]-1]
+    vector<Lit>      cardLits;
+    vector<uint32_t> cardStart;
+    vector<uint32_t> cardOccStart;
+    vector<uint32_t> cardOccs;
+    size_t getNumCards() const;
+
+    ///Propagate the at-most-one constraints of 'p', which has just become TRUE.
+    ///The reasons and conflicts are the implied binary clauses
+    bool propCards(const Lit p, PropBy& confl);
+    PropResult propCardsFull(const Lit p, PropBy& confl);
     bool timedOutPropagateFull;
     Lit propagateFullBFS(const uint64_t earlyAborTOut = std::numeric_limits<uint64_t>::max());
     Lit propagateFullDFS(
@@ -853,6 +879,11 @@ inline void PropEngine::addHyperBin(const Lit p, const Clause& cl)
     addHyperBin(p);
 }
 
+inline size_t PropEngine::getNumCards() const
+{
+    return cardStart.empty() ? 0 : cardStart.size() - 1;
+}
+
 //Analyze why did we fail at decision level 1
 inline Lit PropEngine::analyzeFail(const PropBy propBy)
 {
@@ -986,6 +1017,19 @@ inline void PropEngine::cancelZeroLight()
     trail_lim.clear();
 }
 
+inline void PropEngine::cancelUntilLight(const uint32_t level)
+{
+    assert(decisionLevel() > level);
+
+    for (int sublevel = trail.size()-1; sublevel >= (int)trail_lim[level]; sublevel--) {
+        Var var = trail[sublevel].var();
+        assigns[var] = l_Undef;
+    }
+    qhead = trail_lim[level];
+    trail.resize(trail_lim[level]);
+    trail_lim.resize(level);
+}
+
 inline uint32_t PropEngine::getNumUnitaries() const
 {
     if (decisionLevel() > 0)
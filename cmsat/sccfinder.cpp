@@ -115,9 +115,9 @@ void SCCFinder::tarjan(const uint32_t vertex)
             ; it != end
             ; it++
         ) {
-            //Only binary clauses matter
+            //Only binary clauses matter, and they are at the front
             if (!it->isBinary())
-                continue;
+                break;
 
             const Lit lit = it->lit2();
 
@@ -28,6 +28,8 @@
 #include "sccfinder.h"
 #include "varreplacer.h"
 #include "clausecleaner.h"
+#include "cardfinder.h"
+#include "clausevivifier.h"
 #include "propbyforgraph.h"
 #include <algorithm>
 #include <cstddef>
@@ -66,11 +68,23 @@ Searcher::Searcher(const SolverConf& _conf, Solver* _solver) :
         , conf(_conf)
         , needToInterrupt(false)
         , var_inc(_conf.var_inc_start)
+        , searchMode(SearchMode::focus)
+        , modeConfl(0)
+        , modeProps(0)
+        , modePropsLimit(0)
+        , modeTime(0)
+        , lubyLoop(0)
+        , targetTrail(0)
+        , bestTrail(0)
+        , nextRephase(_conf.rephaseInterval)
+        , numRephases(0)
         , order_heap(VarOrderLt(activities))
         , clauseActivityIncrease(1)
 {
     mtrand.seed(conf.origSeed);
     hist.setSize(conf.shortTermHistorySize);
+    hist.glueEmaFast = EMA(conf.emaGlueFast);
+    hist.glueEmaSlow = EMA(conf.emaGlueSlow);
 }
 
 Searcher::~Searcher()
@@ -767,45 +781,59 @@ stores the result in 'out_conflict'.
 */
 void Searcher::analyzeFinal(const Lit p, vector<Lit>& out_conflict)
 {
+    //The conflict is expressed in the assumptions as given, not in the
+    //literals they are replaced with, which may even be BVA variables.
+    //Every decision level so far belongs to an assumption
+    assert(p == ~solver->varReplacer->getLitReplacedWith(assumptions[decisionLevel()]));
     out_conflict.clear();
-    out_conflict.push_back(p);
+    out_conflict.push_back(~assumptions[decisionLevel()]);
 
     if (decisionLevel() == 0)
         return;
 
+    //Reasons don't always precede the propagated literal on the trail (e.g.
+    //after hyper-binary resolution), so the marks are cleared through toClear
+    toClear.clear();
     seen[p.var()] = 1;
+    toClear.push_back(p);
 
     for (int32_t i = (int32_t)trail.size()-1; i >= (int32_t)trail_lim[0]; i--) {
         const Var x = trail[i].var();
         if (!seen[x])
-            break;
+            continue;
 
         if (varData[x].reason.isNULL()) {
             assert(varData[x].level > 0);
-            out_conflict.push_back(~trail[i]);
+            out_conflict.push_back(~assumptions[varData[x].level-1]);
         } else {
             PropBy confl = varData[x].reason;
             switch(confl.getType()) {
                 case tertiary_t : {
                     const Lit lit2 = confl.lit3();
-                    if (varData[lit2.var()].level > 0)
+                    if (varData[lit2.var()].level > 0 && !seen[lit2.var()]) {
                         seen[lit2.var()] = 1;
+                        toClear.push_back(lit2);
+                    }
 
                     //Intentionally no break, since tertiary is similar to binary
                 }
 
                 case binary_t : {
                     const Lit lit1 = confl.lit2();
-                    if (varData[lit1.var()].level > 0)
+                    if (varData[lit1.var()].level > 0 && !seen[lit1.var()]) {
                         seen[lit1.var()] = 1;
+                        toClear.push_back(lit1);
+                    }
                     break;
                 }
 
                 case clause_t : {
                     const Clause& cl = *clAllocator->getPointer(confl.getClause());
                     for (uint32_t j = 1, size = cl.size(); j < size; j++) {
-                        if (varData[cl[j].var()].level > 0)
+                        if (varData[cl[j].var()].level > 0 && !seen[cl[j].var()]) {
                             seen[cl[j].var()] = 1;
+                            toClear.push_back(cl[j]);
+                        }
                     }
                     break;
                 }
@@ -815,10 +843,16 @@ void Searcher::analyzeFinal(const Lit p, vector<Lit>& out_conflict)
                     break;
             }
         }
-        seen[x] = 0;
     }
 
-    seen[p.var()] = 0;
+    for (vector<Lit>::const_iterator
+        it = toClear.begin(), end = toClear.end()
+        ; it != end
+        ; it++
+    ) {
+        seen[it->var()] = 0;
+    }
+    toClear.clear();
 }
 
 /**
@@ -973,6 +1007,9 @@ lbool Searcher::search(uint64_t* geom_max)
         if (!confl.isNULL()) {
             //Update conflict stats based on lastConflictCausedBy
             stats.conflStats.update(lastConflictCausedBy);
+            if (searchMode == SearchMode::stable) {
+                updateTargetPolarities();
+            }
 
             //If restart is needed, set it as so
             checkNeedRestart(geom_max);
@@ -1100,6 +1137,21 @@ void Searcher::checkNeedRestart(uint64_t* geom_max)
 
             break;
 
+        case Restart::glue_ema:
+            if (params.conflictsDoneThisRestart > 1
+                && hist.glueEmaFast.avg() > conf.emaRestartMargin*hist.glueEmaSlow.avg()
+            ) {
+                params.needToStopSearch = true;
+            }
+
+            break;
+
+        case Restart::luby:
+            if (params.conflictsDoneThisRestart > params.lubyMax)
+                params.needToStopSearch = true;
+
+            break;
+
         case Restart::glue_agility:
             if (hist.glueHist.isvalid()
                 && 0.95*hist.glueHist.avg() > hist.glueHistLT.avg()
@@ -1216,6 +1268,8 @@ bool Searcher::handle_conflict(PropBy confl)
 
         hist.glueHist.push(glue);
         hist.glueHistLT.push(glue);
+        hist.glueEmaFast.push(glue);
+        hist.glueEmaSlow.push(glue);
 
         hist.conflSizeHist.push(learnt_clause.size());
         hist.conflSizeHistLT.push(learnt_clause.size());
@@ -1446,6 +1500,9 @@ bool Searcher::handle_conflict(PropBy confl)
             //Unitary learnt
             stats.learntUnits++;
             enqueue(learnt_clause[0]);
+            if (solver->shared) {
+                solver->exportUnit(learnt_clause[0]);
+            }
             assert(backtrack_level == 0 && "Unit clause learnt, so must cancel until level 0");
 
             #ifdef STATS_NEEDED
@@ -1457,6 +1514,9 @@ bool Searcher::handle_conflict(PropBy confl)
             //Binary learnt
             stats.learntBins++;
             solver->attachBinClause(learnt_clause[0], learnt_clause[1], true);
+            if (solver->shared) {
+                solver->exportBin(learnt_clause[0], learnt_clause[1]);
+            }
             if (conf.otfHyperbin && decisionLevel() == 1)
                 enqueueComplex(learnt_clause[0], ~learnt_clause[1], true);
             else
@@ -1509,16 +1569,193 @@ bool Searcher::handle_conflict(PropBy confl)
 
 void Searcher::genRandomVarActMultDiv()
 {
+    //Stable mode decays slower
+    const uint32_t multiplier = searchMode == SearchMode::stable
+        ? conf.var_inc_multiplier_stable : conf.var_inc_multiplier;
+    const uint32_t divider = searchMode == SearchMode::stable
+        ? conf.var_inc_divider_stable : conf.var_inc_divider;
+
     uint32_t tosubstract = conf.var_inc_variability-mtrand.randInt(2*conf.var_inc_variability);
-    var_inc_multiplier = conf.var_inc_multiplier - tosubstract;
-    var_inc_divider = conf.var_inc_divider - tosubstract;
+    var_inc_multiplier = multiplier - tosubstract;
+    var_inc_divider = divider - tosubstract;
 
     if (conf.verbosity >= 1) {
         cout
         << "c Using var act-multip " << var_inc_multiplier
-        << " instead of standard " << (conf.var_inc_multiplier)
+        << " instead of standard " << multiplier
         << " and act-divider " << var_inc_divider
-        << " instead of standard " << (conf.var_inc_divider)
+        << " instead of standard " << divider
+        << endl;
+    }
+}
+
+/**
+@brief i-th element of the Luby sequence with base y: 1,1,2,1,1,2,4,...
+*/
+static uint64_t luby(const uint64_t y, uint64_t x)
+{
+    //Find the finite subsequence that contains index 'x', and its size
+    uint64_t size = 1;
+    uint64_t seq = 0;
+    while (size < x+1) {
+        seq++;
+        size = 2*size+1;
+    }
+
+    while (size-1 != x) {
+        size = (size-1)>>1;
+        seq--;
+        x = x % size;
+    }
+
+    uint64_t ret = 1;
+    for(uint64_t i = 0; i < seq; i++) {
+        ret *= y;
+    }
+    return ret;
+}
+
+void Searcher::accountModeWork(
+    const uint64_t propsBefore
+    , const uint64_t conflBefore
+) {
+    const uint64_t props = propStats.propagations - propsBefore;
+    const uint64_t confl = stats.conflStats.numConflicts - conflBefore;
+    const double now = cpuTime();
+    modeProps += props;
+    modeConfl += confl;
+
+    if (searchMode == SearchMode::focus) {
+        stats.focusConfl += confl;
+        stats.focusProps += props;
+        stats.focusTime += now - modeTime;
+    } else {
+        stats.stableConfl += confl;
+        stats.stableProps += props;
+        stats.stableTime += now - modeTime;
+    }
+    modeTime = now;
+}
+
+/**
+@brief Switches between focused and stable mode if the current one is over
+
+The first focused phase is conf.modeSwitchFirst conflicts. Every later phase
+gets as many propagations as that took, multiplied by conf.modeSwitchInc after
+every stable phase. Measuring in propagations makes the phases take about the
+same time, even though stable mode has far fewer conflicts per propagation
+*/
+void Searcher::checkModeSwitch()
+{
+    if (modePropsLimit == 0) {
+        if (modeConfl < conf.modeSwitchFirst)
+            return;
+
+        modePropsLimit = std::max<uint64_t>(modeProps, 1);
+    } else if (modeProps < modePropsLimit) {
+        return;
+    }
+
+    if (searchMode == SearchMode::stable) {
+        modePropsLimit *= conf.modeSwitchInc;
+    }
+    setSearchMode(searchMode == SearchMode::focus
+        ? SearchMode::stable : SearchMode::focus);
+}
+
+void Searcher::setSearchMode(const SearchMode mode)
+{
+    if (conf.verbosity >= 2) {
+        cout
+        << "c [mode] " << search_mode_to_string(searchMode)
+        << " -> " << search_mode_to_string(mode)
+        << " after confl: " << modeConfl
+        << " props: " << modeProps
+        << " next props limit: " << modePropsLimit
+        << endl;
+    }
+
+    searchMode = mode;
+    modeConfl = 0;
+    modeProps = 0;
+    stats.modeSwitches++;
+
+    params.rest_type = decide_restart_type();
+    genRandomVarActMultDiv();
+    if (mode == SearchMode::stable) {
+        lubyLoop = 0;
+        targetTrail = 0;
+    }
+}
+
+/**
+@brief Saves the consistent part of the trail as target and best polarities
+
+Everything below the conflicting decision level is consistent. If it is longer
+than what the target (or best) polarities were saved from, they are replaced
+*/
+void Searcher::updateTargetPolarities()
+{
+    if (decisionLevel() == 0)
+        return;
+
+    const size_t consistent = trail_lim.back();
+    if (consistent > targetTrail) {
+        targetTrail = consistent;
+        for(size_t i = 0; i < nVars(); i++) {
+            varData[i].targetPolarity = value(i);
+        }
+    }
+
+    if (consistent > bestTrail) {
+        bestTrail = consistent;
+        for(size_t i = 0; i < nVars(); i++) {
+            varData[i].bestPolarity = value(i);
+        }
+    }
+}
+
+/**
+@brief Resets the polarities to escape the current part of the search space
+
+Cycles through best, original (all false), best, inverted (all true). The
+target polarities are cleared, so they are rebuilt from the new polarities
+*/
+void Searcher::rephase()
+{
+    assert(decisionLevel() == 0);
+    const char type = "BOBI"[numRephases % 4];
+    for(size_t i = 0; i < nVars(); i++) {
+        VarData& dat = varData[i];
+        switch(type) {
+            case 'B':
+                if (dat.bestPolarity != l_Undef)
+                    dat.polarity = (dat.bestPolarity == l_True);
+                break;
+
+            case 'O':
+                dat.polarity = false;
+                break;
+
+            case 'I':
+                dat.polarity = true;
+                break;
+        }
+        dat.targetPolarity = l_Undef;
+    }
+
+    targetTrail = 0;
+    if (type == 'B') {
+        bestTrail = 0;
+    }
+    numRephases++;
+    stats.rephases++;
+    nextRephase = sumConflicts() + conf.rephaseInterval*numRephases;
+
+    if (conf.verbosity >= 2) {
+        cout
+        << "c [rephase] " << type
+        << " next at confl: " << nextRephase
         << endl;
     }
 }
@@ -1909,6 +2146,10 @@ void Searcher::printClauseDistribSQL()
 Restart Searcher::decide_restart_type() const
 {
     Restart rest_type = conf.restartType;
+    if (rest_type == Restart::modeswitch) {
+        return searchMode == SearchMode::focus ? Restart::glue_ema : Restart::luby;
+    }
+
     if (rest_type == Restart::automatic) {
         if (solver->sumPropStats.propagations == 0) {
 
@@ -2014,8 +2255,13 @@ lbool Searcher::solve(const vector<Lit>& assumps, const uint64_t maxConfls)
         assert(order_heap.heapProperty());
 
         //Set up data for search
+        if (conf.restartType != Restart::modeswitch) {
+            searchMode = conf.restartType == Restart::luby
+                ? SearchMode::stable : SearchMode::focus;
+        }
         params.rest_type = decide_restart_type();
         genRandomVarActMultDiv();
+        modeTime = cpuTime();
 
         //Set up restart printing status
         lastRestartPrint = stats.conflStats.numConflicts;
@@ -2048,8 +2294,14 @@ lbool Searcher::solve(const vector<Lit>& assumps, const uint64_t maxConfls)
         //Set up params
         params.clear();
         params.conflictsToDo = maxConfls-stats.conflStats.numConflicts;
+        if (params.rest_type == Restart::luby) {
+            params.lubyMax = conf.lubyUnit*luby(2, lubyLoop++);
+        }
+        const uint64_t propsBefore = propStats.propagations;
+        const uint64_t conflBefore = stats.conflStats.numConflicts;
         status = search(&geom_max);
         geom_max *= conf.restart_inc;
+        accountModeWork(propsBefore, conflBefore);
         check_if_print_restart_stat(status);
 
         if (status != l_Undef) {
@@ -2093,6 +2345,18 @@ lbool Searcher::solve(const vector<Lit>& assumps, const uint64_t maxConfls)
                 << " Trail size: " << trail.size() << endl;
             }
             solver->fullReduce();
+            if (!solver->ok) {
+                status = l_False;
+                break;
+            }
+
+            //Vivify the learnt clauses that were kept
+            if (conf.doVivifLearnt
+                && !solver->clauseVivifier->vivifyLearnt()
+            ) {
+                status = l_False;
+                break;
+            }
 
             genRandomVarActMultDiv();
         }
@@ -2127,6 +2391,11 @@ lbool Searcher::solve(const vector<Lit>& assumps, const uint64_t maxConfls)
                 << endl;
             }
 
+            //Variable replacement only knows about clauses
+            if (!solver->cardFinder->restoreBins()) {
+                status = l_False;
+                break;
+            }
             solver->clauseCleaner->removeAndCleanAll();
 
             //Find eq lits
@@ -2146,6 +2415,25 @@ lbool Searcher::solve(const vector<Lit>& assumps, const uint64_t maxConfls)
             }
         }
 
+        if (conf.restartType == Restart::modeswitch) {
+            checkModeSwitch();
+        }
+
+        if (searchMode == SearchMode::stable
+            && sumConflicts() >= nextRephase
+        ) {
+            rephase();
+        }
+
+        //Exchange learnt units and binaries with the rest of the portfolio
+        if (solver->shared
+            && sumConflicts() >= solver->nextSyncConfl
+            && !solver->syncShared()
+        ) {
+            status = l_False;
+            break;
+        }
+
         #ifdef STATS_NEEDED
         if (conf.doSQL) {
             printRestartSQL();
@@ -2233,6 +2521,11 @@ bool Searcher::pickPolarity(const Var var)
             return mtrand.randInt(1);
 
         case PolarityMode::automatic:
+            if (searchMode == SearchMode::stable
+                && varData[var].targetPolarity != l_Undef
+            ) {
+                return varData[var].targetPolarity == l_True;
+            }
             return getStoredPolarity(var);
         default:
             assert(false);
@@ -75,6 +75,8 @@ class Searcher : public PropEngine
             //About the confl generated
             bqueue<uint32_t>    glueHist;            ///< Set of last decision levels in (glue of) conflict clauses
             AvgCalc<uint32_t>   glueHistLT;
+            EMA                 glueEmaFast; ///<Not cleared at restart, used for EMA restarts
+            EMA                 glueEmaSlow;
 
             AvgCalc<uint32_t>   conflSizeHist;       ///< Conflict size history
             AvgCalc<uint32_t>   conflSizeHistLT;
@@ -270,6 +272,16 @@ class Searcher : public PropEngine
                 , transReduRemIrred(0)
                 , transReduRemRed(0)
 
+                //Focused/stable modes
+                , focusConfl(0)
+                , focusProps(0)
+                , focusTime(0)
+                , stableConfl(0)
+                , stableProps(0)
+                , stableTime(0)
+                , modeSwitches(0)
+                , rephases(0)
+
                 //Time
                 , cpu_time(0)
 
@@ -327,6 +339,16 @@ class Searcher : public PropEngine
                 transReduRemIrred += other.transReduRemIrred;
                 transReduRemRed += other.transReduRemRed;
 
+                //Focused/stable modes
+                focusConfl += other.focusConfl;
+                focusProps += other.focusProps;
+                focusTime += other.focusTime;
+                stableConfl += other.stableConfl;
+                stableProps += other.stableProps;
+                stableTime += other.stableTime;
+                modeSwitches += other.modeSwitches;
+                rephases += other.rephases;
+
                 //Stat structs
                 resolvs += other.resolvs;
                 conflStats += other.conflStats;
@@ -382,6 +404,16 @@ class Searcher : public PropEngine
                 transReduRemIrred -= other.transReduRemIrred;
                 transReduRemRed -= other.transReduRemRed;
 
+                //Focused/stable modes
+                focusConfl -= other.focusConfl;
+                focusProps -= other.focusProps;
+                focusTime -= other.focusTime;
+                stableConfl -= other.stableConfl;
+                stableProps -= other.stableProps;
+                stableTime -= other.stableTime;
+                modeSwitches -= other.modeSwitches;
+                rephases -= other.rephases;
+
                 //Stat structs
                 resolvs -= other.resolvs;
                 conflStats -= other.conflStats;
@@ -418,10 +450,50 @@ class Searcher : public PropEngine
                 );
             }
 
+            void printModes() const
+            {
+                if (modeSwitches == 0 && stableConfl == 0)
+                    return;
+
+                printStatsLine("c focus mode confl"
+                    , focusConfl
+                    , (double)focusConfl/(double)(focusConfl + stableConfl)*100.0
+                    , "% of conflicts"
+                );
+                printStatsLine("c focus mode props"
+                    , focusProps
+                    , (double)focusProps/(double)focusConfl
+                    , "props/confl"
+                );
+                printStatsLine("c focus mode time"
+                    , focusTime
+                    , (double)focusConfl/focusTime
+                    , "confl/s"
+                );
+                printStatsLine("c stable mode confl"
+                    , stableConfl
+                    , (double)stableConfl/(double)(focusConfl + stableConfl)*100.0
+                    , "% of conflicts"
+                );
+                printStatsLine("c stable mode props"
+                    , stableProps
+                    , (double)stableProps/(double)stableConfl
+                    , "props/confl"
+                );
+                printStatsLine("c stable mode time"
+                    , stableTime
+                    , (double)stableConfl/stableTime
+                    , "confl/s"
+                );
+                printStatsLine("c mode switches", modeSwitches);
+                printStatsLine("c rephases", rephases);
+            }
+
             void printShort() const
             {
                 //Restarts stats
                 printCommon();
+                printModes();
                 conflStats.printShort(cpu_time);
 
                 printStatsLine("c conf lits non-minim"
@@ -439,6 +511,7 @@ class Searcher : public PropEngine
             {
                 uint64_t mem_used = memUsed();
                 printCommon();
+                printModes();
                 conflStats.print(cpu_time);
 
                 /*assert(numConflicts
@@ -618,6 +691,16 @@ class Searcher : public PropEngine
             uint64_t transReduRemIrred;
             uint64_t transReduRemRed;
 
+            //Focused/stable modes
+            uint64_t focusConfl;
+            uint64_t focusProps;
+            double   focusTime;
+            uint64_t stableConfl;
+            uint64_t stableProps;
+            double   stableTime;
+            uint64_t modeSwitches;
+            uint64_t rephases;
+
             //Resolution Stats
             ResolutionTypes<uint64_t> resolvs;
 
@@ -695,6 +778,7 @@ class Searcher : public PropEngine
             uint64_t conflictsDoneThisRestart;
             uint64_t conflictsToDo;
             uint64_t numAgilityNeedRestart;
+            uint64_t lubyMax; ///<Conflicts of this restart when doing Luby restarts
             Restart rest_type;
         };
         SearchParams params;
@@ -754,6 +838,26 @@ class Searcher : public PropEngine
         void              insertVarOrder(const Var x);  ///< Insert a variable in heap
         void  genRandomVarActMultDiv();
 
+        /////////////////
+        // Focused/stable mode switching
+        SearchMode searchMode;
+        uint64_t modeConfl; ///<Conflicts done in the current mode
+        uint64_t modeProps; ///<Propagations done in the current mode
+        uint64_t modePropsLimit; ///<Switch mode after this many propagations. 0 during the first focused phase
+        double   modeTime; ///<When the current mode was last accounted for
+        uint64_t lubyLoop;
+        void  accountModeWork(const uint64_t propsBefore, const uint64_t conflBefore);
+        void  checkModeSwitch();
+        void  setSearchMode(const SearchMode mode);
+
+        //Target polarities and rephasing
+        size_t   targetTrail; ///<Length of the consistent trail the target polarities are from
+        size_t   bestTrail; ///<Length of the consistent trail the best polarities are from
+        uint64_t nextRephase;
+        uint64_t numRephases;
+        void  updateTargetPolarities();
+        void  rephase();
+
         ////////////
         // Transitive on-the-fly self-subsuming resolution
         void   minimiseLearntFurther(vector<Lit>& cl);
@@ -0,0 +1,213 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "shareddata.h"
+
+using namespace CMSat;
+using std::cout;
+using std::endl;
+
+SharedData::SharedData(const size_t _numThreads, const bool _deterministic) :
+    numThreads(_numThreads)
+    , deterministic(_deterministic)
+    , arrived(0)
+    , barriersDone(0)
+    , stopAll(false)
+    , numDone(0)
+    , winner(std::numeric_limits<size_t>::max())
+{
+    outbox[0].resize(numThreads);
+    outbox[1].resize(numThreads);
+    epoch.resize(numThreads, 0);
+    unitsRead.resize(numThreads, 0);
+    binsRead.resize(numThreads, 0);
+    result.resize(numThreads, l_Undef);
+    finishedEpoch.resize(numThreads, 0);
+}
+
+void SharedData::exportUnit(const size_t t, const Lit lit)
+{
+    if (deterministic) {
+        //Only thread "t" touches its outbox of the current epoch
+        outbox[epoch[t] % 2][t].units.push_back(lit);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mu);
+    allUnits.push_back(lit);
+    allUnitsFrom.push_back(t);
+    stats.exportedUnits++;
+}
+
+void SharedData::exportBin(const size_t t, const Lit lit1, const Lit lit2)
+{
+    if (deterministic) {
+        Outbox& box = outbox[epoch[t] % 2][t];
+        box.bins.push_back(lit1);
+        box.bins.push_back(lit2);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mu);
+    allBins.push_back(lit1);
+    allBins.push_back(lit2);
+    allBinsFrom.push_back(t);
+    stats.exportedBins++;
+}
+
+/**
+@brief Must be called with the lock held
+
+The barrier is passed once every thread has either arrived or is done. Which
+threads have finished is decided here, so it only depends on what happened
+before the barrier.
+*/
+void SharedData::completeBarrierIfReady()
+{
+    if (arrived == 0
+        || arrived + numDone < numThreads
+    ) {
+        return;
+    }
+
+    for(size_t i = 0; i < numThreads; i++) {
+        if (result[i] != l_Undef) {
+            stopAll = true;
+        }
+    }
+    arrived = 0;
+    barriersDone++;
+    barrierCond.notify_all();
+}
+
+bool SharedData::sync(const size_t t, vector<Lit>& units, vector<Lit>& bins)
+{
+    std::unique_lock<std::mutex> lock(mu);
+    stats.numSyncs++;
+
+    if (!deterministic) {
+        for(size_t i = unitsRead[t]; i < allUnits.size(); i++) {
+            if (allUnitsFrom[i] != t)
+                units.push_back(allUnits[i]);
+        }
+        unitsRead[t] = allUnits.size();
+
+        for(size_t i = binsRead[t]; i < allBinsFrom.size(); i++) {
+            if (allBinsFrom[i] != t) {
+                bins.push_back(allBins[i*2]);
+                bins.push_back(allBins[i*2+1]);
+            }
+        }
+        binsRead[t] = allBinsFrom.size();
+
+        return !stopAll;
+    }
+
+    const uint64_t myBarrier = epoch[t] + 1;
+    stats.exportedUnits += outbox[epoch[t] % 2][t].units.size();
+    stats.exportedBins += outbox[epoch[t] % 2][t].bins.size()/2;
+    arrived++;
+    completeBarrierIfReady();
+    if (barriersDone < myBarrier) {
+        stats.numWaits++;
+    }
+    while(barriersDone < myBarrier) {
+        barrierCond.wait(lock);
+    }
+    epoch[t] = myBarrier;
+
+    if (stopAll)
+        return false;
+
+    //Get what the others learnt in the last epoch, in thread order
+    const vector<Outbox>& boxes = outbox[(myBarrier-1) % 2];
+    for(size_t i = 0; i < numThreads; i++) {
+        if (i == t)
+            continue;
+
+        units.insert(units.end(), boxes[i].units.begin(), boxes[i].units.end());
+        bins.insert(bins.end(), boxes[i].bins.begin(), boxes[i].bins.end());
+    }
+
+    //Everybody has read this one in the previous barrier
+    outbox[myBarrier % 2][t].units.clear();
+    outbox[myBarrier % 2][t].bins.clear();
+
+    return true;
+}
+
+void SharedData::finished(const size_t t, const lbool res)
+{
+    std::lock_guard<std::mutex> lock(mu);
+    numDone++;
+    result[t] = res;
+    finishedEpoch[t] = epoch[t];
+
+    if (deterministic) {
+        completeBarrierIfReady();
+    } else if (res != l_Undef) {
+        if (winner == std::numeric_limits<size_t>::max()) {
+            winner = t;
+        }
+        stopAll = true;
+    }
+}
+
+/**
+@brief The solver whose result should be used, once all threads are done
+*/
+size_t SharedData::getWinner() const
+{
+    std::lock_guard<std::mutex> lock(mu);
+    if (!deterministic) {
+        return (winner == std::numeric_limits<size_t>::max()) ? 0 : winner;
+    }
+
+    size_t best = 0;
+    bool found = false;
+    for(size_t i = 0; i < numThreads; i++) {
+        if (result[i] == l_Undef)
+            continue;
+
+        if (!found || finishedEpoch[i] < finishedEpoch[best]) {
+            best = i;
+            found = true;
+        }
+    }
+
+    return best;
+}
+
+void SharedData::printStats() const
+{
+    std::lock_guard<std::mutex> lock(mu);
+    printStatsLine("c portfolio syncs"
+        , stats.numSyncs
+        , (double)stats.numWaits/(double)stats.numSyncs*100.0
+        , "% had to wait"
+    );
+    printStatsLine("c portfolio exported units"
+        , stats.exportedUnits
+    );
+    printStatsLine("c portfolio exported bins"
+        , stats.exportedBins
+    );
+}
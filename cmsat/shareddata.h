@@ -0,0 +1,120 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __SHAREDDATA_H__
+#define __SHAREDDATA_H__
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+using std::vector;
+
+/**
+@brief Learnt units and binaries exchanged between the solvers of a portfolio
+
+All literals are in OUTER numbering, which is the same in all solvers, since
+they all read the same problem.
+
+Solvers call sync() every syncEveryConfl conflicts (at the first restart
+after that). In deterministic mode sync() is a barrier: solver t gets
+exactly the clauses the others learnt up to the same conflict count, in
+thread order, so the run does not depend on thread timing. Once a solver
+finishes, the others stop at the next barrier, and the winner is the lowest
+numbered solver that finished. In non-deterministic mode sync() never waits,
+it gets whatever has been exported so far, and the first to finish wins.
+*/
+class SharedData
+{
+    public:
+        SharedData(const size_t numThreads, const bool deterministic);
+
+        //Called by thread "t" only, literals in outer numbering
+        void exportUnit(const size_t t, const Lit lit);
+        void exportBin(const size_t t, const Lit lit1, const Lit lit2);
+
+        //Returns FALSE if thread "t" must stop. Clauses to import are
+        //appended to units and bins (bins as pairs of literals)
+        bool sync(const size_t t, vector<Lit>& units, vector<Lit>& bins);
+
+        //Thread "t" returned from solve()
+        void finished(const size_t t, const lbool result);
+        size_t getWinner() const;
+
+        struct Stats
+        {
+            Stats() :
+                numSyncs(0)
+                , numWaits(0)
+                , exportedUnits(0)
+                , exportedBins(0)
+            {}
+
+            uint64_t numSyncs;
+            uint64_t numWaits;
+            uint64_t exportedUnits;
+            uint64_t exportedBins;
+        };
+        void printStats() const;
+
+    private:
+        size_t numThreads;
+        bool deterministic;
+
+        mutable std::mutex mu;
+        std::condition_variable barrierCond;
+
+        //Deterministic mode: per-thread outboxes, double-buffered by barrier
+        struct Outbox
+        {
+            vector<Lit> units;
+            vector<Lit> bins;
+        };
+        vector<Outbox> outbox[2];
+        vector<uint64_t> epoch; ///<Number of barriers passed by thread
+        size_t arrived;
+        uint64_t barriersDone;
+        bool stopAll;
+        void completeBarrierIfReady();
+
+        //Non-deterministic mode: everything in one place
+        vector<Lit> allUnits;
+        vector<size_t> allUnitsFrom;
+        vector<Lit> allBins;
+        vector<size_t> allBinsFrom;
+        vector<size_t> unitsRead;
+        vector<size_t> binsRead;
+
+        //Finishing
+        size_t numDone;
+        vector<lbool> result;
+        vector<uint64_t> finishedEpoch;
+        size_t winner;
+
+        Stats stats;
+};
+
+} //end namespace
+
+#endif //__SHAREDDATA_H__
@@ -37,7 +37,6 @@
 #include "solver.h"
 #include "clausecleaner.h"
 #include "constants.h"
-#include "solutionextender.h"
 #include "gatefinder.h"
 #include "varreplacer.h"
 #include "varupdatehelper.h"
@@ -74,9 +73,13 @@ using std::endl;
 Simplifier::Simplifier(Solver* _solver):
     solver(_solver)
     , varElimOrder(VarOrderLt(varElimComplexity))
+    , elimWithGate(false)
+    , elimNeededGate(false)
+    , elimResSkipped(0)
     , xorFinder(NULL)
     , anythingHasBeenBlocked(false)
     , blockedMapBuilt(false)
+    , blockedClausesGen(0)
 {
     #ifdef USE_M4RI
     if (solver->conf.doFindXors) {
@@ -143,7 +146,12 @@ void Simplifier::print_blocked_clauses_reverse() const
     }
 }
 
-void Simplifier::extendModel(SolutionExtender* extender)
+/**
+@brief Returns the blocked clauses, cleaned, for the solution extender
+
+The clauses are in outer numbering, and must be processed in reverse order
+*/
+const vector<BlockedClause>& Simplifier::getBlockedClausesForExtend()
 {
     //Either a variable is not eliminated, or its value is false
     for(size_t i = 0; i < var_elimed.size(); i++) {
@@ -156,18 +164,7 @@ void Simplifier::extendModel(SolutionExtender* extender)
     print_blocked_clauses_reverse();
     #endif
 
-    //go through in reverse order
-    for (vector<BlockedClause>::const_reverse_iterator
-        it = blockedClauses.rbegin(), end = blockedClauses.rend()
-        ; it != end
-        ; it++
-    ) {
-        vector<Lit> lits(it->lits);
-        updateLitsMap(lits, solver->outerToInterMain);
-        Lit blockedOn = getUpdatedLit(it->blockedOn, solver->outerToInterMain);
-        bool ret = extender->addClause(lits, blockedOn);
-        assert(ret);
-    }
+    return blockedClauses;
 }
 
 /**
@@ -995,6 +992,471 @@ end:
     return solver->ok;
 }
 
+/**
+@brief Bounded variable addition, as per Manthey, Heule and Biere (SimpleBVA)
+
+Encodings such as the naive at-most-one have clause patterns like
+    (a v c1), (a v c2), ... (b v c1), (b v c2), ...
+i.e. a set of literals M_lit, each appearing with every clause of a set M_cls.
+These |M_lit|*|M_cls| clauses are replaced with |M_lit| + |M_cls| clauses
+using a fresh variable x:
+    (l v x) for every l in M_lit, and (C v -x) for every C in M_cls
+The new formula implies the old one (resolving on x gives the old clauses),
+and x can always be set to satisfy the new clauses, so no reconstruction is
+needed. Only the variable x must be projected away from the model, which is
+done by Solver.
+
+Literals are tried in the order of the number of their irredundant occurrences.
+*/
+bool Simplifier::boundedVarAddition()
+{
+    #ifdef DRUP
+    //The new clauses are not RUP
+    if (solver->drup)
+        return solver->ok;
+    #endif
+
+    assert(solver->ok);
+    const double myTime = cpuTime();
+    toDecrease = &numMaxBva;
+
+    //Queue literals that could be factored out
+    bvaQueue = std::priority_queue<pair<size_t, Lit> >();
+    bvaLitCount.clear();
+    bvaLitCount.resize(solver->nVars()*2, 0);
+    for(size_t i = 0; i < solver->nVars()*2; i++) {
+        const Lit lit = Lit::toLit(i);
+        if (!bvaCanUse(lit.var()))
+            continue;
+
+        const size_t num = numIrredOccs(lit);
+        if (num >= 3) {
+            bvaQueue.push(std::make_pair(num, lit));
+        }
+    }
+
+    while(!bvaQueue.empty()
+        && *toDecrease > 0
+        && solver->ok
+    ) {
+        const size_t num = bvaQueue.top().first;
+        const Lit lit = bvaQueue.top().second;
+        bvaQueue.pop();
+        if (!bvaCanUse(lit.var()))
+            continue;
+
+        //Number of occurrences changed since it was queued
+        const size_t realNum = numIrredOccs(lit);
+        if (realNum != num) {
+            if (realNum >= 3) {
+                bvaQueue.push(std::make_pair(realNum, lit));
+            }
+            continue;
+        }
+
+        if (tryBva(lit)) {
+            //The literal, and the new variable may be factored out again
+            const Var newVar = solver->nVars()-1;
+            const Lit newLit = Lit(newVar, true);
+            const size_t numNew = numIrredOccs(newLit);
+            if (numNew >= 3) {
+                bvaQueue.push(std::make_pair(numNew, newLit));
+            }
+            const size_t numLit = numIrredOccs(lit);
+            if (numLit >= 3) {
+                bvaQueue.push(std::make_pair(numLit, lit));
+            }
+        }
+    }
+
+    runStats.bvaTimeOut += (*toDecrease <= 0);
+    runStats.bvaTime += cpuTime() - myTime;
+
+    return solver->ok;
+}
+
+bool Simplifier::bvaCanUse(const Var var) const
+{
+    return solver->value(var) == l_Undef
+        && solver->varData[var].removed == Removed::none;
+}
+
+/**
+@brief Number of literals saved by re-encoding M_lit x M_cls
+*/
+int64_t Simplifier::bvaReduction(const size_t numLits, const size_t numCls) const
+{
+    return (int64_t)numLits*(int64_t)numCls - (int64_t)numLits - (int64_t)numCls;
+}
+
+size_t Simplifier::numIrredOccs(const Lit lit)
+{
+    const vec<Watched>& ws = solver->watches[lit.toInt()];
+    *toDecrease -= ws.size();
+
+    size_t num = 0;
+    for(vec<Watched>::const_iterator
+        it = ws.begin(), end = ws.end()
+        ; it != end
+        ; it++
+    ) {
+        if (it->isClause()) {
+            num += !solver->clAllocator->getPointer(it->getOffset())->learnt();
+        } else {
+            num += !it->learnt();
+        }
+    }
+
+    return num;
+}
+
+/**
+@brief Gets the literals of an irredundant clause in the occur list of 'lit'
+
+@return FALSE if the clause is learnt or has an assigned literal
+*/
+bool Simplifier::getIrredLits(
+    const Lit lit
+    , const Watched& ws
+    , vector<Lit>& out
+) const {
+    out.clear();
+    if (ws.isBinary() || ws.isTri()) {
+        if (ws.learnt())
+            return false;
+
+        out.push_back(lit);
+        out.push_back(ws.lit2());
+        if (ws.isTri()) {
+            out.push_back(ws.lit3());
+        }
+    } else {
+        const Clause& cl = *solver->clAllocator->getPointer(ws.getOffset());
+        if (cl.learnt())
+            return false;
+
+        out.insert(out.end(), cl.begin(), cl.end());
+    }
+
+    for(vector<Lit>::const_iterator
+        it = out.begin(), end = out.end()
+        ; it != end
+        ; it++
+    ) {
+        if (solver->value(*it) != l_Undef)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+@brief Tries to find M_lit and M_cls for 'lit', and re-encodes them if it's worth it
+
+Greedily adds the literal to M_lit that keeps the most clauses in M_cls, as
+long as the reduction in the number of clauses keeps growing
+
+@return TRUE if a new variable has been added
+*/
+bool Simplifier::tryBva(const Lit lit)
+{
+    bvaLits.clear();
+    bvaLits.push_back(lit);
+    bvaCls.clear();
+    const vec<Watched>& ws = solver->watches[lit.toInt()];
+    for(vec<Watched>::const_iterator
+        it = ws.begin(), end = ws.end()
+        ; it != end
+        ; it++
+    ) {
+        if (getIrredLits(lit, *it, bvaTmp)) {
+            bvaCls.push_back(*it);
+        }
+    }
+    *toDecrease -= ws.size();
+
+    while(*toDecrease > 0) {
+        bvaFindPairs(lit);
+
+        //The literal that would keep the most clauses
+        Lit maxLit = lit_Undef;
+        uint32_t maxCount = 0;
+        for(vector<Lit>::const_iterator
+            it = bvaCounted.begin(), end = bvaCounted.end()
+            ; it != end
+            ; it++
+        ) {
+            if (bvaLitCount[it->toInt()] > maxCount) {
+                maxCount = bvaLitCount[it->toInt()];
+                maxLit = *it;
+            }
+            bvaLitCount[it->toInt()] = 0;
+        }
+        bvaCounted.clear();
+
+        if (maxLit == lit_Undef
+            || bvaReduction(bvaLits.size() + 1, maxCount)
+                <= bvaReduction(bvaLits.size(), bvaCls.size())
+        ) {
+            break;
+        }
+
+        //Keep only the clauses that appear with the new literal, too
+        bvaLits.push_back(maxLit);
+        uint32_t lastKept = std::numeric_limits<uint32_t>::max();
+        size_t j = 0;
+        for(vector<pair<Lit, uint32_t> >::const_iterator
+            it = bvaPairs.begin(), end = bvaPairs.end()
+            ; it != end
+            ; it++
+        ) {
+            //Pairs are in the order of the clauses, and at most one per clause
+            if (it->first == maxLit) {
+                assert(lastKept == std::numeric_limits<uint32_t>::max()
+                    || lastKept < it->second);
+                lastKept = it->second;
+                bvaCls[j++] = bvaCls[it->second];
+            }
+        }
+        assert(j == maxCount);
+        bvaCls.resize(j);
+    }
+
+    if (bvaLits.size() == 1
+        || bvaReduction(bvaLits.size(), bvaCls.size()) < solver->conf.bvaMinGain
+    ) {
+        return false;
+    }
+
+    bvaReplace(lit);
+    return true;
+}
+
+/**
+@brief Finds the literals that appear with every clause of M_cls in place of 'lit'
+
+For clause C in M_cls, a pair (l, C) is found if (C \ {lit}) v l is an
+irredundant clause. Only the occur list of the least occurring literal in
+C \ {lit} needs to be checked.
+*/
+void Simplifier::bvaFindPairs(const Lit lit)
+{
+    bvaPairs.clear();
+    for(size_t i = 0; i < bvaCls.size(); i++) {
+        getIrredLits(lit, bvaCls[i], bvaTmp);
+
+        //Mark C \ {lit}
+        Lit minLit = lit_Undef;
+        for(vector<Lit>::const_iterator
+            it = bvaTmp.begin(), end = bvaTmp.end()
+            ; it != end
+            ; it++
+        ) {
+            if (*it == lit)
+                continue;
+
+            seen[it->toInt()] = 1;
+            if (minLit == lit_Undef
+                || solver->watches[it->toInt()].size()
+                    < solver->watches[minLit.toInt()].size()
+            ) {
+                minLit = *it;
+            }
+        }
+        assert(minLit != lit_Undef);
+
+        const size_t origNumPairs = bvaPairs.size();
+        const vec<Watched>& ws = solver->watches[minLit.toInt()];
+        *toDecrease -= ws.size() + bvaTmp.size();
+        for(vec<Watched>::const_iterator
+            it = ws.begin(), end = ws.end()
+            ; it != end
+            ; it++
+        ) {
+            if (!getIrredLits(minLit, *it, bvaTmp2)
+                || bvaTmp2.size() != bvaTmp.size()
+            ) {
+                continue;
+            }
+            *toDecrease -= bvaTmp2.size();
+
+            //Must be C \ {lit} plus one literal that is not 'lit' (i.e. not C)
+            Lit diff = lit_Undef;
+            size_t numDiff = 0;
+            for(vector<Lit>::const_iterator
+                it2 = bvaTmp2.begin(), end2 = bvaTmp2.end()
+                ; it2 != end2 && numDiff <= 1
+                ; it2++
+            ) {
+                if (!seen[it2->toInt()]) {
+                    numDiff++;
+                    diff = *it2;
+                }
+            }
+
+            if (numDiff != 1
+                || diff.var() == lit.var()
+                || seen2[diff.toInt()] //Duplicate clause
+                || std::find(bvaLits.begin(), bvaLits.end(), diff) != bvaLits.end()
+            ) {
+                continue;
+            }
+
+            seen2[diff.toInt()] = 1;
+            bvaPairs.push_back(std::make_pair(diff, (uint32_t)i));
+            if (bvaLitCount[diff.toInt()]++ == 0) {
+                bvaCounted.push_back(diff);
+            }
+        }
+
+        //Clear
+        for(vector<Lit>::const_iterator
+            it = bvaTmp.begin(), end = bvaTmp.end()
+            ; it != end
+            ; it++
+        ) {
+            seen[it->toInt()] = 0;
+        }
+        for(size_t at = origNumPairs; at < bvaPairs.size(); at++) {
+            seen2[bvaPairs[at].first.toInt()] = 0;
+        }
+    }
+}
+
+/**
+@brief Replaces the M_lit x M_cls clauses with the new variable
+*/
+void Simplifier::bvaReplace(const Lit lit)
+{
+    //Save M_cls without 'lit', long clauses will be freed
+    vector<Lit> clsLits;
+    vector<uint32_t> clsStart;
+    for(vector<Watched>::const_iterator
+        it = bvaCls.begin(), end = bvaCls.end()
+        ; it != end
+        ; it++
+    ) {
+        clsStart.push_back(clsLits.size());
+        getIrredLits(lit, *it, bvaTmp);
+        for(vector<Lit>::const_iterator
+            it2 = bvaTmp.begin(), end2 = bvaTmp.end()
+            ; it2 != end2
+            ; it2++
+        ) {
+            if (*it2 != lit)
+                clsLits.push_back(*it2);
+        }
+    }
+    clsStart.push_back(clsLits.size());
+
+    if (solver->conf.verbosity >= 5) {
+        cout
+        << "c [bva] replacing " << bvaLits.size() << " x " << bvaCls.size()
+        << " clauses on lits " << bvaLits
+        << endl;
+    }
+
+    //Remove (C \ {lit}) v l for all l in M_lit and C in M_cls
+    vector<Lit> lits;
+    for(size_t i = 0; i + 1 < clsStart.size(); i++) {
+        for(vector<Lit>::const_iterator
+            it = bvaLits.begin(), end = bvaLits.end()
+            ; it != end
+            ; it++
+        ) {
+            lits.assign(clsLits.begin() + clsStart[i], clsLits.begin() + clsStart[i+1]);
+            lits.push_back(*it);
+            std::sort(lits.begin(), lits.end());
+
+            //A duplicate clause may already have been removed. That's fine,
+            //the clause is implied by the new clauses anyway
+            runStats.bvaClsRemoved += removeIrredClause(lits);
+        }
+    }
+
+    //Add the new variable and clauses
+    const Var newVar = solver->newBvaVar();
+    bvaLitCount.resize(solver->nVars()*2, 0);
+    runStats.bvaVarsAdded++;
+    const Lit newLit = Lit(newVar, false);
+    assert(solver->nVars()-1 == newVar);
+
+    for(vector<Lit>::const_iterator
+        it = bvaLits.begin(), end = bvaLits.end()
+        ; it != end
+        ; it++
+    ) {
+        lits.clear();
+        lits.push_back(*it);
+        lits.push_back(newLit);
+        Clause* newCl = solver->addClauseInt(lits, false, ClauseStats(), false);
+        assert(newCl == NULL);
+        runStats.bvaClsAdded++;
+    }
+
+    for(size_t i = 0; i + 1 < clsStart.size(); i++) {
+        lits.assign(clsLits.begin() + clsStart[i], clsLits.begin() + clsStart[i+1]);
+        lits.push_back(~newLit);
+        Clause* newCl = solver->addClauseInt(lits, false, ClauseStats(), false);
+        if (newCl != NULL) {
+            linkInClause(*newCl);
+            clauses.push_back(solver->clAllocator->getOffset(newCl));
+        }
+        runStats.bvaClsAdded++;
+    }
+}
+
+/**
+@brief Removes the irredundant clause with exactly these (sorted) literals
+
+@return FALSE if there is no such clause
+*/
+bool Simplifier::removeIrredClause(const vector<Lit>& lits)
+{
+    Lit minLit = lits[0];
+    for(vector<Lit>::const_iterator
+        it = lits.begin(), end = lits.end()
+        ; it != end
+        ; it++
+    ) {
+        if (solver->watches[it->toInt()].size()
+            < solver->watches[minLit.toInt()].size()
+        ) {
+            minLit = *it;
+        }
+    }
+
+    const vec<Watched>& ws = solver->watches[minLit.toInt()];
+    *toDecrease -= ws.size();
+    for(vec<Watched>::const_iterator
+        it = ws.begin(), end = ws.end()
+        ; it != end
+        ; it++
+    ) {
+        if (!getIrredLits(minLit, *it, bvaTmp2)
+            || bvaTmp2.size() != lits.size()
+        ) {
+            continue;
+        }
+
+        std::sort(bvaTmp2.begin(), bvaTmp2.end());
+        if (bvaTmp2 != lits)
+            continue;
+
+        if (it->isBinary()) {
+            solver->detachBinClause(lits[0], lits[1], false);
+        } else if (it->isTri()) {
+            solver->detachTriClause(lits[0], lits[1], lits[2], false);
+        } else {
+            unlinkClause(it->getOffset());
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
 bool Simplifier::propagate()
 {
     assert(solver->ok);
@@ -1412,6 +1874,12 @@ bool Simplifier::simplify()
         goto end;
     }
 
+    //Re-encode clause patterns with new variables. Done after var-elim,
+    //which would not eliminate the new variables anyway
+    if (solver->conf.doBva && !boundedVarAddition()) {
+        goto end;
+    }
+
     assert(solver->ok);
 
 end:
@@ -1456,6 +1924,10 @@ end:
             runStats.print(solver->nVars());
         else
             runStats.printShort(solver->conf.doVarElim);
+
+        if (solver->conf.doBva && solver->conf.verbosity < 3) {
+            runStats.printShortBva();
+        }
     }
 
     return solver->ok;
@@ -1506,7 +1978,7 @@ bool Simplifier::unEliminate(Var var)
         #ifdef VERBOSE_DEBUG_RECONSTRUCT
         cout << "Uneliminating " << cl << " on var " << var+1 << endl;
         #endif
-        solver->addClause(cl);
+        solver->addClauseOuter(cl);
         if (!solver->okay())
             return false;
     }
@@ -2287,6 +2759,7 @@ void Simplifier::setLimits()
     numMaxBlocked     = 40LL *1000LL*1000LL;
     numMaxBlockedImpl = 1800LL *1000LL*1000LL;
     numMaxVarElimAgressiveCheck  = 300LL *1000LL*1000LL;
+    numMaxBva         = solver->conf.bvaLimitM*1000LL*1000LL;
 
     //numMaxElim = 0;
     //numMaxElim = std::numeric_limits<int64_t>::max();
@@ -2366,6 +2839,9 @@ void Simplifier::cleanBlockedClauses()
             *j++ = *i;
         }
     }
+    if (i != j) {
+        blockedClausesGen++;
+    }
     blockedClauses.resize(blockedClauses.size()-(i-j));
 }
 
@@ -2610,6 +3086,188 @@ uint32_t Simplifier::numNonLearntBins(const Lit lit) const
     return num;
 }
 
+bool Simplifier::isIrred(const Watched& ws) const
+{
+    if (ws.isBinary() || ws.isTri())
+        return !ws.learnt();
+
+    const Clause* cl = solver->clAllocator->getPointer(ws.getOffset());
+    return !cl->learnt() && !cl->freed();
+}
+
+/**
+@brief Finds the irreducible binary (lit2) or tri (lit2, lit3) clause in occur list
+
+@return index of the clause in the occur list, or -1 if not found
+*/
+int32_t Simplifier::findIrredBinTri(
+    const vec<Watched>& occ
+    , Lit lit2
+    , Lit lit3
+) const {
+    if (lit3 != lit_Undef && lit3 < lit2)
+        std::swap(lit2, lit3);
+
+    *toDecrease -= occ.size()/4 + 1;
+    for(uint32_t i = 0; i < occ.size(); i++) {
+        const Watched& ws = occ[i];
+        if (lit3 == lit_Undef) {
+            if (ws.isBinary() && !ws.learnt() && ws.lit2() == lit2)
+                return i;
+        } else {
+            if (ws.isTri() && !ws.learnt()
+                && ws.lit2() == lit2 && ws.lit3() == lit3
+            ) {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+/**
+@brief Finds out = AND(b_1, ..., b_k) in the irreducible clauses
+
+The definition is (~out V b_i) for every i, and (out V ~b_1 V ... V ~b_k).
+This also covers OR gates, as ~out = OR(~b_1, ..., ~b_k). On success, the
+defining clauses are marked in outInGate and negInGate
+*/
+bool Simplifier::findAndGateDef(
+    const Lit out
+    , const vec<Watched>& outOcc
+    , const vec<Watched>& negOcc
+    , vector<char>& outInGate
+    , vector<char>& negInGate
+) {
+    //Mark every b_i of the (~out V b_i) binaries
+    *toDecrease -= negOcc.size();
+    for(vec<Watched>::const_iterator
+        it = negOcc.begin(), end = negOcc.end()
+        ; it != end
+        ; it++
+    ) {
+        if (it->isBinary() && !it->learnt())
+            seen[it->lit2().toInt()] = 1;
+    }
+
+    //Find the long one, whose every other literal is a marked ~b_i
+    bool found = false;
+    for(uint32_t i = 0; i < outOcc.size() && !found; i++) {
+        const Watched& ws = outOcc[i];
+        if (!isIrred(ws))
+            continue;
+
+        dummy.clear();
+        if (ws.isBinary() || ws.isTri()) {
+            dummy.push_back(ws.lit2());
+            if (ws.isTri())
+                dummy.push_back(ws.lit3());
+        } else {
+            const Clause& cl = *solver->clAllocator->getPointer(ws.getOffset());
+            *toDecrease -= cl.size();
+            for(uint32_t i2 = 0; i2 < cl.size(); i2++) {
+                if (cl[i2] != out)
+                    dummy.push_back(cl[i2]);
+            }
+        }
+
+        found = true;
+        for(vector<Lit>::const_iterator
+            it = dummy.begin(), end = dummy.end()
+            ; it != end
+            ; it++
+        ) {
+            if (!seen[(~*it).toInt()]) {
+                found = false;
+                break;
+            }
+        }
+
+        if (found) {
+            outInGate[i] = 1;
+            for(vector<Lit>::const_iterator
+                it = dummy.begin(), end = dummy.end()
+                ; it != end
+                ; it++
+            ) {
+                const int32_t at = findIrredBinTri(negOcc, ~*it);
+                assert(at >= 0);
+                negInGate[at] = 1;
+            }
+        }
+    }
+
+    //Clear 'seen'
+    for(vec<Watched>::const_iterator
+        it = negOcc.begin(), end = negOcc.end()
+        ; it != end
+        ; it++
+    ) {
+        if (it->isBinary())
+            seen[it->lit2().toInt()] = 0;
+    }
+
+    return found;
+}
+
+/**
+@brief Finds var = XOR(a, b) in the irreducible tri clauses
+
+The definition is the four tri clauses over the var, a and b with the same
+parity. On success, they are marked in posInGate and negInGate
+*/
+bool Simplifier::findXorGateDef(
+    const vec<Watched>& poss
+    , const vec<Watched>& negs
+) {
+    for(uint32_t i = 0; i < poss.size() && *toDecrease > 0; i++) {
+        const Watched& ws = poss[i];
+        if (!ws.isTri() || ws.learnt())
+            continue;
+
+        const Lit a = ws.lit2();
+        const Lit b = ws.lit3();
+        const int32_t pos2 = findIrredBinTri(poss, ~a, ~b);
+        if (pos2 < 0)
+            continue;
+
+        const int32_t neg1 = findIrredBinTri(negs, ~a, b);
+        const int32_t neg2 = findIrredBinTri(negs, a, ~b);
+        if (neg1 < 0 || neg2 < 0)
+            continue;
+
+        posInGate[i] = 1;
+        posInGate[pos2] = 1;
+        negInGate[neg1] = 1;
+        negInGate[neg2] = 1;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+@brief Finds a gate defining var, and marks its clauses in posInGate and negInGate
+
+If var is defined by a gate, resolving two gate clauses gives a tautology, and
+resolving two non-gate clauses gives a clause implied by the gate-vs-non-gate
+resolvents. So only the gate-vs-non-gate resolvents need to be added
+*/
+bool Simplifier::findGateDef(
+    const Var var
+    , const vec<Watched>& poss
+    , const vec<Watched>& negs
+) {
+    const Lit lit = Lit(var, false);
+    posInGate.assign(poss.size(), 0);
+    negInGate.assign(negs.size(), 0);
+
+    return findAndGateDef(lit, poss, negs, posInGate, negInGate)
+        || findAndGateDef(~lit, negs, poss, negInGate, posInGate)
+        || findXorGateDef(poss, negs);
+}
+
 int Simplifier::testVarElim(const Var var)
 {
     assert(solver->ok);
@@ -2617,6 +3275,9 @@ int Simplifier::testVarElim(const Var var)
     assert(solver->varData[var].removed == Removed::none);
     //assert(solver->decisionVar[var]);
     assert(solver->value(var) == l_Undef);
+    elimWithGate = false;
+    elimNeededGate = false;
+    elimResSkipped = 0;
 
     //Gather data
     HeuristicData pos = calcDataForHeuristic(Lit(var, false));
@@ -2649,6 +3310,9 @@ int Simplifier::testVarElim(const Var var)
     if (posSize >= 15 && negSize >= 15)
         return -1000;*/
 
+    //Only gate-vs-non-gate resolvents are needed if var is defined by a gate
+    elimWithGate = solver->conf.doGateElim && findGateDef(var, poss, negs);
+
     // Count clauses/literals after elimination
     uint32_t before_clauses = pos.bin + pos.tri + pos.longer + neg.bin + neg.tri + neg.longer;
     uint32_t after_clauses = 0;
@@ -2689,6 +3353,14 @@ int Simplifier::testVarElim(const Var var)
                 continue;
             }
 
+            //Both are gate, or both are non-gate clauses
+            if (elimWithGate
+                && posInGate[it - poss.begin()] == negInGate[it2 - negs.begin()]
+            ) {
+                elimResSkipped += !posInGate[it - poss.begin()];
+                continue;
+            }
+
             //Resolve the two clauses
             bool ok = merge(*it, *it2, lit, agressive);
 
@@ -2733,6 +3405,10 @@ int Simplifier::testVarElim(const Var var)
         }
     }
 
+    //Upper bound: some of the skipped ones would have been tautological
+    elimNeededGate = elimWithGate
+        && after_clauses + elimResSkipped > before_clauses;
+
     //Smaller value returned, the better
     int cost = after_long + after_tri + after_bin*3
         - pos.longer - neg.longer
@@ -2794,11 +3470,16 @@ bool Simplifier::maybeEliminate(const Var var)
 
     //Test if we should remove, and fill posAll&negAll
     runStats.testedToElimVars++;
-    if (testVarElim(var) == 1000) {
+    const int cost = testVarElim(var);
+    runStats.gateDefsFound += elimWithGate;
+    if (cost == 1000) {
         return false;
     }
 
     runStats.triedToElimVars++;
+    runStats.gateElimed += elimWithGate;
+    runStats.gateEnabledElim += elimNeededGate;
+    runStats.gateResSkipped += elimResSkipped;
 
     //The literal
     const Lit lit = Lit(var, false);
@@ -2969,13 +3650,13 @@ end:
     const vec<Watched>& ws2 = solver->watches[lit.toInt()];
 
     for (vec<Watched>::const_iterator w1 = ws.begin(), end1 = ws.end(); w1 != end1; w1++) {
-        if (!w1->isBinary()) continue;
+        if (!w1->isBinary()) break;
         const bool numOneIsLearnt = w1->learnt();
         const Lit lit1 = w1->lit2();
         if (solver->value(lit1) != l_Undef || var_elimed[lit1.var()]) continue;
 
         for (vec<Watched>::const_iterator w2 = ws2.begin(), end2 = ws2.end(); w2 != end2; w2++) {
-            if (!w2->isBinary()) continue;
+            if (!w2->isBinary()) break;
             const bool numTwoIsLearnt = w2->learnt();
             if (!numOneIsLearnt && !numTwoIsLearnt) {
                 //At least one must be learnt
@@ -3683,6 +4364,13 @@ uint64_t Simplifier::memUsed() const
     b += varElimComplexity.capacity()*sizeof(int)*2;
     b += touched.memUsed();
     b += clauses.capacity()*sizeof(ClOffset);
+    b += bvaLits.capacity()*sizeof(Lit);
+    b += bvaCls.capacity()*sizeof(Watched);
+    b += bvaPairs.capacity()*sizeof(pair<Lit, uint32_t>);
+    b += bvaLitCount.capacity()*sizeof(uint32_t);
+    b += bvaCounted.capacity()*sizeof(Lit);
+    b += bvaTmp.capacity()*sizeof(Lit);
+    b += bvaTmp2.capacity()*sizeof(Lit);
 
     return b;
 }
@@ -50,7 +50,6 @@ using std::pair;
 using std::priority_queue;
 
 class ClauseCleaner;
-class SolutionExtender;
 class Solver;
 class GateFinder;
 class XorFinderAbst;
@@ -102,7 +101,8 @@ public:
 
     //UnElimination
     void print_blocked_clauses_reverse() const;
-    void extendModel(SolutionExtender* extender);
+    const vector<BlockedClause>& getBlockedClausesForExtend();
+    uint64_t getBlockedClausesGen() const;
 
     //Get-functions
     struct Stats
@@ -116,6 +116,7 @@ public:
             , subsumeTime(0)
             , strengthenTime(0)
             , varElimTime(0)
+            , bvaTime(0)
             , finalCleanupTime(0)
 
             //Startup stats
@@ -148,6 +149,16 @@ public:
             , triedToElimVars(0)
             , usedAgressiveCheckToELim(0)
             , newClauses(0)
+            , gateDefsFound(0)
+            , gateElimed(0)
+            , gateEnabledElim(0)
+            , gateResSkipped(0)
+
+            //BVA
+            , bvaVarsAdded(0)
+            , bvaClsRemoved(0)
+            , bvaClsAdded(0)
+            , bvaTimeOut(0)
 
             , zeroDepthAssings(0)
         {
@@ -157,7 +168,7 @@ public:
         {
             return linkInTime + blockTime + asymmTime
                 + subsumeTime + strengthenTime
-                + varElimTime + finalCleanupTime;
+                + varElimTime + bvaTime + finalCleanupTime;
         }
 
         void clear()
@@ -177,6 +188,7 @@ public:
             subsumeTime += other.subsumeTime;
             strengthenTime += other.strengthenTime;
             varElimTime += other.varElimTime;
+            bvaTime += other.bvaTime;
             finalCleanupTime += other.finalCleanupTime;
 
             //Startup stats
@@ -209,6 +221,16 @@ public:
             triedToElimVars += other.triedToElimVars;
             usedAgressiveCheckToELim += other.usedAgressiveCheckToELim;
             newClauses += other.newClauses;
+            gateDefsFound += other.gateDefsFound;
+            gateElimed += other.gateElimed;
+            gateEnabledElim += other.gateEnabledElim;
+            gateResSkipped += other.gateResSkipped;
+
+            //BVA
+            bvaVarsAdded += other.bvaVarsAdded;
+            bvaClsRemoved += other.bvaClsRemoved;
+            bvaClsAdded += other.bvaClsAdded;
+            bvaTimeOut += other.bvaTimeOut;
 
             zeroDepthAssings += other.zeroDepthAssings;
 
@@ -229,6 +251,19 @@ public:
             << endl;
         }
 
+        void printShortBva() const
+        {
+            cout
+            << "c [bva]"
+            << " vars-added: " << bvaVarsAdded
+            << " cls-rem: " << bvaClsRemoved
+            << " cls-added: " << bvaClsAdded
+            << " T: " << std::fixed << std::setprecision(2)
+            << bvaTime << " s"
+            << " T-out: " << bvaTimeOut
+            << endl;
+        }
+
         void printShort(const bool print_var_elim = true) const
         {
             printShortSubStr();
@@ -264,6 +299,14 @@ public:
                 << " learnt-long rem: " << longLearntClRemThroughElim
                 << " v-fix: " << std::setw(4) << zeroDepthAssings
                 << endl;
+
+                cout
+                << "c [v-elim]"
+                << " gate-defs: " << gateDefsFound
+                << " gate-elimed: " << gateElimed
+                << " gate-enabled: " << gateEnabledElim
+                << " res-skipped: " << gateResSkipped
+                << endl;
             }
 
             cout
@@ -323,6 +366,18 @@ public:
                 , "% agressively"
             );
 
+            printStatsLine("c elimed with gate def"
+                , gateElimed
+                , (double)gateElimed/(double)numVarsElimed*100.0
+                , "% of elimed"
+            );
+
+            printStatsLine("c enabled by gate def"
+                , gateEnabledElim
+                , (double)gateEnabledElim/(double)numVarsElimed*100.0
+                , "% of elimed"
+            );
+
             printStatsLine("c cl-subs"
                 , subsumedBySub + subsumedByStr + subsumedByVE
                 , (double)(subsumedBySub + subsumedByStr + subsumedByVE)
@@ -364,6 +419,22 @@ public:
                 ((double)clauses_elimed_sumsize
                 /(double)(clauses_elimed_bin + clauses_elimed_tri + clauses_elimed_long))
             );
+
+            printStatsLine("c bva vars added"
+                , bvaVarsAdded
+            );
+
+            printStatsLine("c bva cls removed"
+                , bvaClsRemoved
+                , (double)bvaClsAdded/(double)bvaClsRemoved*100.0
+                , "% added back"
+            );
+
+            printStatsLine("c bva time"
+                , bvaTime
+                , (double)bvaTimeOut/(double)numCalls*100.0
+                , "% time-outed"
+            );
             cout << "c -------- Simplifier STATS END ----------" << endl;
         }
 
@@ -376,6 +447,7 @@ public:
         double subsumeTime;
         double strengthenTime;
         double varElimTime;
+        double bvaTime;
         double finalCleanupTime;
 
         //Startup stats
@@ -408,6 +480,16 @@ public:
         uint64_t triedToElimVars;
         uint64_t usedAgressiveCheckToELim;
         uint64_t newClauses;
+        uint64_t gateDefsFound; ///<Vars tried to elim that were defined by a gate
+        uint64_t gateElimed; ///<Vars elimed using only gate-vs-non-gate resolvents
+        uint64_t gateEnabledElim; ///<..of which would have been over the resolvent limit without
+        uint64_t gateResSkipped; ///<Non-gate-vs-non-gate resolvents skipped
+
+        //Stats for BVA
+        uint64_t bvaVarsAdded;
+        uint64_t bvaClsRemoved;
+        uint64_t bvaClsAdded;
+        uint64_t bvaTimeOut;
 
         //General stat
         uint64_t zeroDepthAssings;
@@ -456,6 +538,7 @@ private:
     int64_t  numMaxBlocked;
     int64_t  numMaxBlockedImpl;
     int64_t  numMaxVarElimAgressiveCheck;
+    int64_t  numMaxBva;
     int64_t* toDecrease;
 
     //Propagation&handling of stuff
@@ -636,6 +719,24 @@ private:
     int         testVarElim(Var var);
     vector<pair<vector<Lit>, ClauseStats> > resolvents;
 
+    //Gate definitions for var-elim
+    bool        findGateDef(const Var var, const vec<Watched>& poss, const vec<Watched>& negs);
+    bool        findAndGateDef(
+        const Lit out
+        , const vec<Watched>& outOcc
+        , const vec<Watched>& negOcc
+        , vector<char>& outInGate
+        , vector<char>& negInGate
+    );
+    bool        findXorGateDef(const vec<Watched>& poss, const vec<Watched>& negs);
+    int32_t     findIrredBinTri(const vec<Watched>& occ, Lit lit2, Lit lit3 = lit_Undef) const;
+    bool        isIrred(const Watched& ws) const;
+    vector<char> posInGate; ///<Clauses of the pos occur list that define the var as a gate
+    vector<char> negInGate; ///<Clauses of the neg occur list that define the var as a gate
+    bool        elimWithGate; ///<Last testVarElim() used a gate definition
+    bool        elimNeededGate; ///<..and would have been over the resolvent limit without it
+    uint32_t    elimResSkipped; ///<Non-gate-vs-non-gate resolvents skipped by last testVarElim()
+
     struct HeuristicData
     {
         HeuristicData() :
@@ -681,6 +782,26 @@ private:
     bool        eliminateVars();
     bool        loopSubsumeVarelim();
 
+    /////////////////////
+    //Bounded variable addition
+    bool        boundedVarAddition();
+    bool        tryBva(const Lit lit);
+    void        bvaFindPairs(const Lit lit);
+    void        bvaReplace(const Lit lit);
+    bool        bvaCanUse(const Var var) const;
+    size_t      numIrredOccs(const Lit lit);
+    bool        getIrredLits(const Lit lit, const Watched& ws, vector<Lit>& out) const;
+    bool        removeIrredClause(const vector<Lit>& lits);
+    int64_t     bvaReduction(const size_t numLits, const size_t numCls) const;
+    std::priority_queue<pair<size_t, Lit> > bvaQueue;
+    vector<Lit>      bvaLits; ///<Literals that are factored out (M_lit)
+    vector<Watched>  bvaCls; ///<Occurrences of the literal the rest appears with (M_cls)
+    vector<pair<Lit, uint32_t> > bvaPairs; ///<Literal that could be added to M_lit, clause in M_cls
+    vector<uint32_t> bvaLitCount; ///<Number of pairs, per literal
+    vector<Lit>      bvaCounted;
+    vector<Lit>      bvaTmp;
+    vector<Lit>      bvaTmp2;
+
     /////////////////////
     //XOR finding
     friend class XorFinder;
@@ -696,6 +817,7 @@ private:
     vector<BlockedClause> blockedClauses;
     map<Var, vector<size_t> > blk_var_to_cl;
     bool blockedMapBuilt;
+    uint64_t blockedClausesGen; ///<Incremented every time blocked clauses are removed
     void buildBlockedMap();
     void cleanBlockedClauses();
 
@@ -839,6 +961,11 @@ inline const vector<BlockedClause>& Simplifier::getBlockedClauses() const
     return blockedClauses;
 }
 
+inline uint64_t Simplifier::getBlockedClausesGen() const
+{
+    return blockedClausesGen;
+}
+
 inline bool Simplifier::getVarElimed(const Var var) const
 {
     return var_elimed[var];
@@ -23,24 +23,26 @@
 #include "varreplacer.h"
 #include "simplifier.h"
 #include "solver.h"
-#include "completedetachreattacher.h"
+#include "time_mem.h"
+#include <algorithm>
 using namespace CMSat;
 using std::cout;
 using std::endl;
 
-SolutionExtender::SolutionExtender(
-    Solver* _solver
-    , const vector<lbool>& _solution
-) :
+SolutionExtender::SolutionExtender(Solver* _solver) :
     solver(_solver)
-    , qhead (0)
-    , assigns(_solution)
+    , compiled(false)
+    , compiledGen(0)
+    , compiledNumBlocked(0)
+    , compiledNumReplaced(0)
+    , compiledNumVars(0)
+    , havePrev(false)
 {
-    solver->model.resize(nVarsReal(), l_Undef);
-    for (Var var = 0; var < nVarsReal(); var++) {
-        solver->model[var] = value(var);
-    }
-    release_assert(solver->verifyModel());
+}
+
+void SolutionExtender::setProjection(const vector<Var>& outerVars)
+{
+    projection = outerVars;
 }
 
 /**
@@ -50,407 +52,457 @@ variable elimination, variable replacement, sub-part solving, etc. all need to
 be handled correctly to arrive at a solution that is a solution to ALL of the
 original problem, not just of what remained of it at the end inside this class
 (i.e. we need to combine things from the helper classes)
+
+The solution is in internal numbering, and so is the resulting solver->model
 */
-void SolutionExtender::extend()
+void SolutionExtender::extend(const vector<lbool>& solution)
 {
+    const double myTime = cpuTime();
+    runStats.clear();
+    runStats.numCalls = 1;
     if (solver->conf.verbosity >= 3) {
         cout << "c Extending solution" << endl;
     }
 
-    assert(clausesToFree.empty());
-
-    //First detach all long clauses
-    CompleteDetachReatacher detachReattach(solver);
-    detachReattach.detachNonBinsNonTris();
-
-    //Make watches large enough to fit occur of all
-    solver->watches.resize(nVarsReal()*2);
-
     //Sanity check
     if (solver->simplifier) {
         solver->simplifier->checkElimedUnassignedAndStats();
     }
 
-    //Adding binary clauses representing equivalent literals
-    if (solver->conf.verbosity >= 3) {
-        cout << "c Adding equivalent literals" << endl;
-    }
-    solver->varReplacer->extendModel(this);
-
-    if (solver->conf.verbosity >= 3) {
-        cout << "c Picking braches and propagating" << endl;
+    compileIfNeeded();
+    calcDefaults(solution);
+
+    if (!projection.empty()) {
+        projectedSweep();
+        fillModel(cur, solution, &inProjection);
+    } else {
+        if (havePrev) {
+            incrementalSweep();
+        } else {
+            fullSweep();
+        }
+        fillModel(prevFinal, solution, NULL);
     }
 
-    //Pick branches as long as we can
-    for (Var var = 0; var < nVarsReal(); var++) {
-        if (value(var) == l_Undef
-            //Don't pick replaced variables
-            && solver->varData[var].removed != Removed::replaced
-        ) {
-            Lit toEnqueue = Lit(var, false);
-            #ifdef VERBOSE_DEBUG_RECONSTRUCT
-            cout << "c Picking lit for reconstruction: " << toEnqueue << endl;
-            #endif
-            enqueue(toEnqueue);
-
-            const bool OK = propagate();
-            if (!OK) {
-                cout
-                << "Error while picking lit " << toEnqueue
-                << " and propagating after solution reconstruction"
-                << endl;
-                assert(false);
+    release_assert(solver->verifyModel());
 
-                exit(-1);
-            }
-        }
+    runStats.cpu_time = cpuTime() - myTime;
+    if (solver->conf.verbosity >= 2) {
+        runStats.printShort();
     }
+    globalStats += runStats;
+}
 
-    if (solver->conf.verbosity >= 3) {
-        cout << "c Adding blocked clauses" << endl;
-    }
+/**
+@brief Recompiles the steps if the blocked clauses, the replacements or the
+number of variables have changed since the last compilation
+*/
+void SolutionExtender::compileIfNeeded()
+{
+    const vector<BlockedClause>* blocked = NULL;
+    uint64_t gen = 0;
     if (solver->simplifier) {
-        solver->simplifier->extendModel(this);
+        blocked = &solver->simplifier->getBlockedClausesForExtend();
+        gen = solver->simplifier->getBlockedClausesGen();
     }
+    const size_t numBlocked = blocked ? blocked->size() : 0;
 
-    //Copy&check model
-    solver->model.resize(nVarsReal(), l_Undef);
-    for (Var var = 0; var < nVarsReal(); var++) {
-        solver->model[var] = value(var);
-    }
-
-    release_assert(solver->verifyModel());
-
-    //free clauses
-    for (vector<ClOffset>::iterator
-        it = clausesToFree.begin(), end = clausesToFree.end()
-        ; it != end
-        ; it++
+    if (compiled
+        && compiledGen == gen
+        && compiledNumBlocked == numBlocked
+        && compiledNumReplaced == solver->varReplacer->getNumReplacedVars()
+        && compiledNumVars == solver->nVarsReal()
     ) {
-        solver->clAllocator->clauseFree(*it);
+        return;
     }
-    clausesToFree.clear();
 
-    //Reset watch size to smaller one
-    solver->watches.resize(solver->nVars()*2);
+    compiled = true;
+    compiledGen = gen;
+    compiledNumBlocked = numBlocked;
+    compiledNumReplaced = solver->varReplacer->getNumReplacedVars();
+    compiledNumVars = solver->nVarsReal();
+    havePrev = false;
+    runStats.numCompiles++;
 
-    //Remove occur, go back to 0, and
-    detachReattach.detachNonBinsNonTris();
-    solver->cancelUntil(0);
-    detachReattach.reattachLongs();
+    buildAlias();
+    compileSteps();
 }
 
-bool SolutionExtender::satisfiedNorm(const vector<Lit>& lits) const
+void SolutionExtender::buildAlias()
 {
-    for (vector<Lit>::const_iterator
-        it = lits.begin(), end = lits.end()
-        ; it != end
-        ; it++
-    ) {
-        if (value(*it) == l_True)
-            return true;
+    const vector<Lit>& table = solver->varReplacer->getReplaceTable();
+    alias.resize(solver->nVarsReal());
+    for(Var outer = 0; outer < solver->nVarsReal(); outer++) {
+        const Var inter = solver->outerToInterMain[outer];
+        const Lit rep = table[inter];
+        alias[outer] = Lit(solver->interToOuterMain[rep.var()], rep.sign());
     }
-
-    return false;
 }
 
-bool SolutionExtender::satisfiedXor(const vector<Lit>& lits, const bool rhs) const
+void SolutionExtender::compileSteps()
 {
-    bool val = false;
-    uint32_t undef = 0;
-    for (vector<Lit>::const_iterator it = lits.begin(), end = lits.end(); it != end; it++) {
-        assert(it->unsign() == *it);
-        if (value(it->var()) == l_True) val ^= true;
-        if (value(it->var()) == l_Undef) undef++;
-    }
-    return (undef > 0 || val == rhs);
-}
+    const size_t numVars = solver->nVarsReal();
+    stepLits.clear();
+    stepStart.clear();
+    stepBlockedOn.clear();
 
-bool SolutionExtender::addClause(
-    const vector< Lit >& givenLits
-    , const Lit blockedOn
-) {
-    tmpLits = givenLits;
+    if (solver->simplifier) {
+        const vector<BlockedClause>& blocked
+            = solver->simplifier->getBlockedClauses();
 
-    //Remove lits set at 0-level or return TRUE if any is set to TRUE at 0-level
-    vector<Lit>::iterator i = tmpLits.begin();
-    vector<Lit>::iterator j = i;
-    for (vector<Lit>::iterator end = tmpLits.end(); i != end; i++) {
-        if (value(*i) == l_True && solver->varData[i->var()].level == 0) {
-            return true;
+        for(vector<BlockedClause>::const_iterator
+            it = blocked.begin(), end = blocked.end()
+            ; it != end
+            ; it++
+        ) {
+            assert(!it->toRemove);
+            stepStart.push_back(stepLits.size());
+            stepBlockedOn.push_back(alias[it->blockedOn.var()] ^ it->blockedOn.sign());
+            for(vector<Lit>::const_iterator
+                it2 = it->lits.begin(), end2 = it->lits.end()
+                ; it2 != end2
+                ; it2++
+            ) {
+                stepLits.push_back(alias[it2->var()] ^ it2->sign());
+            }
         }
-
-        if (value(*i) == l_False && solver->varData[i->var()].level == 0) {
-            continue;
+    }
+    stepStart.push_back(stepLits.size());
+    const uint32_t numSteps = stepBlockedOn.size();
+
+    //Occurrence lists, counting sort so that they are ascending
+    occStart.assign(numVars+1, 0);
+    blkStart.assign(numVars+1, 0);
+    for(uint32_t i = 0; i < numSteps; i++) {
+        for(uint32_t at = stepStart[i]; at < stepStart[i+1]; at++) {
+            occStart[stepLits[at].var()+1]++;
         }
-
-        *j++ = *i;
+        blkStart[stepBlockedOn[i].var()+1]++;
     }
-    tmpLits.resize(tmpLits.size()-(i-j));
-
-    #ifdef VERBOSE_DEBUG_RECONSTRUCT
-    cout << "c Adding extend clause: " << tmpLits << " blocked on: " << blockedOn << endl;
-    #endif
-
-    //Empty clause, oops!
-    if (tmpLits.empty())
-        return false;
-
-    //Create new clause, and add it
-    Clause* cl = solver->clAllocator->Clause_new(
-        tmpLits //the literals
-        , 0 //the time it was created -- useless, ignoring
-        , true //yes, this is extender, so don't care if it's <=3 in size
-    );
-    ClOffset offset = solver->clAllocator->getOffset(cl);
-    clausesToFree.push_back(offset);
-    for (vector<Lit>::const_iterator
-        it = tmpLits.begin(), end = tmpLits.end()
-        ; it != end
-        ; it++
-    ) {
-        //Special used of blocked Lit -- for blocking, but not in the same
-        //sense as the original
-        solver->watches[it->toInt()].push(Watched(offset, blockedOn));
+    for(size_t var = 0; var < numVars; var++) {
+        occStart[var+1] += occStart[var];
+        blkStart[var+1] += blkStart[var];
     }
-
-    propagateCl(cl, blockedOn);
-    if (!propagate()) {
-        assert(false);
-        return false;
+    occ.resize(occStart[numVars]);
+    blk.resize(blkStart[numVars]);
+
+    vector<uint32_t> occAt(occStart.begin(), occStart.end()-1);
+    vector<uint32_t> blkAt(blkStart.begin(), blkStart.end()-1);
+    for(uint32_t i = 0; i < numSteps; i++) {
+        for(uint32_t at = stepStart[i]; at < stepStart[i+1]; at++) {
+            const Var var = stepLits[at].var();
+
+            //Same var can be in the clause twice due to replacement
+            if (occAt[var] == occStart[var] || occ[occAt[var]-1] != i) {
+                occ[occAt[var]++] = i;
+            }
+        }
+        blk[blkAt[stepBlockedOn[i].var()]++] = i;
     }
 
-    return true;
-}
+    //Duplicates were skipped, close the gaps
+    uint32_t j = 0;
+    for(size_t var = 0; var < numVars; var++) {
+        const uint32_t start = occStart[var];
+        occStart[var] = j;
+        for(uint32_t at = start; at < occAt[var]; at++) {
+            occ[j++] = occ[at];
+        }
+    }
+    occStart[numVars] = j;
+    occ.resize(j);
 
-inline bool SolutionExtender::propBinaryClause(
-    const vec<Watched>::const_iterator i
-    , const Lit p
-) {
-    const lbool val = value(i->lit2());
-    if (val == l_Undef) {
-        #ifdef VERBOSE_DEBUG_RECONSTRUCT
+    if (solver->conf.verbosity >= 3) {
         cout
-        << "c Due to cl "
-        << ~p << ", " << i->lit2()
-        << " propagate enqueueing "
-        << i->lit2() << endl;
-        #endif
-        enqueue(i->lit2());
-    } else if (val == l_False){
-        return false;
+        << "c Compiled " << numSteps << " extension steps"
+        << " with " << stepLits.size() << " literals"
+        << endl;
     }
-
-    return true;
 }
 
-inline bool SolutionExtender::propTriClause(
-    const vec<Watched>::const_iterator i
-    , const Lit p
-) {
-    const Lit lit2 = i->lit2();
-    lbool val2 = value(lit2);
-
-    //literal is already satisfied, nothing to do
-    if (val2 == l_True)
-        return true;
-
-    const Lit lit3 = i->lit3();
-    lbool val3 = value(lit3);
+/**
+@brief Value of each representative before any blocked clause is processed
 
-    //literal is already satisfied, nothing to do
-    if (val3 == l_True)
-        return true;
+Eliminated (i.e. unassigned) variables are set to TRUE
+*/
+void SolutionExtender::calcDefaults(const vector<lbool>& solution)
+{
+    defaults.resize(solver->nVarsReal());
+    for(Var outer = 0; outer < solver->nVarsReal(); outer++) {
+        if (alias[outer].var() != outer) {
+            defaults[outer] = l_Undef;
+            continue;
+        }
 
-    if (val2 == l_False && val3 == l_False) {
-        return false;
-    }
-    if (val2 == l_Undef && val3 == l_False) {
-        #ifdef VERBOSE_DEBUG_RECONSTRUCT
-        cout
-        << "c Due to cl "
-        << ~p << ", "
-        << i->lit2() << ", "
-        << i->lit3()
-        << " propagate enqueueing "
-        << lit2 << endl;
-        #endif
-        enqueue(lit2);
-        return true;
-    }
-
-    if (val3 == l_Undef && val2 == l_False) {
-        #ifdef VERBOSE_DEBUG_RECONSTRUCT
-        cout
-        << "c Due to cl "
-        << ~p << ", "
-        << i->lit2() << ", "
-        << i->lit3()
-        << " propagate enqueueing "
-        << lit3 << endl;
-        #endif
-        enqueue(lit3);
-        return true;
+        const lbool val = solution[solver->outerToInterMain[outer]];
+        defaults[outer] = (val == l_Undef) ? l_True : val;
     }
+}
 
-    return true;
+inline lbool SolutionExtender::outerValue(const Lit lit) const
+{
+    return cur[lit.var()] ^ lit.sign();
 }
 
-bool SolutionExtender::propagate()
+inline bool SolutionExtender::stepSatisfied(const uint32_t at) const
 {
-    bool ret = true;
-    while(qhead < trail.size()) {
-        const Lit p = trail[qhead++];
-        const vec<Watched>& ws = solver->watches[(~p).toInt()];
-        for(vec<Watched>::const_iterator
-            it = ws.begin(), end = ws.end()
-            ; it != end
-            ; it++
-        ) {
-            if (it->isBinary() && !it->learnt()) {
-                bool thisret = propBinaryClause(it, p);
-                ret &= thisret;
-                if (!thisret) {
-                    cout
-                    << "Problem with implicit binary clause: "
-                    << ~p
-                    << ", " << it->lit2()
-                    << endl;
-                }
-
-                continue;
-            }
+    for(uint32_t i = stepStart[at]; i < stepStart[at+1]; i++) {
+        if (outerValue(stepLits[i]) == l_True)
+            return true;
+    }
 
-            //Propagate tri clause
-            if (it->isTri() && !it->learnt()) {
-                bool thisret = propTriClause(it, p);
-                ret &= thisret;
-                if (!thisret) {
-                    cout
-                    << "Problem with implicit tertiary clause: "
-                    << ~p
-                    << ", " << it->lit2()
-                    << ", " << it->lit3()
-                    << endl;
-                }
-
-                continue;
-            }
+    return false;
+}
 
-            if (it->isClause()) {
-                ClOffset offset = it->getOffset();
-                const Clause* cl = solver->clAllocator->getPointer(offset);
-                const Lit blockedOn = it->getBlockedLit();
-                const bool thisRet = propagateCl(cl, blockedOn);
-                if (!thisRet) {
-                    cout << "Problem with clause: " << (*it) << endl;
-                }
-                ret &= thisRet;
-            }
+void SolutionExtender::fullSweep()
+{
+    runStats.numFull++;
+    const uint32_t numSteps = stepBlockedOn.size();
+    cur = defaults;
+    prevFlip.assign(numSteps, false);
+    for(uint32_t i = numSteps; i > 0;) {
+        i--;
+        if (!stepSatisfied(i)) {
+            #ifdef VERBOSE_DEBUG_RECONSTRUCT
+            cout << "c Flipping " << stepBlockedOn[i] << " at step " << i << endl;
+            #endif
+            const Lit blockedOn = stepBlockedOn[i];
+            cur[blockedOn.var()] = boolToLBool(!blockedOn.sign());
+            prevFlip[i] = true;
+            runStats.flips++;
         }
     }
+    runStats.stepsTotal += numSteps;
+    runStats.stepsVisited += numSteps;
 
-    return ret;
+    prevDefault = defaults;
+    prevFinal = cur;
+    diff.assign(solver->nVarsReal(), false);
+    havePrev = true;
 }
 
-bool SolutionExtender::propagateCl(
-    const Clause* cl
-    , const Lit blockedOn
-) {
-    size_t numUndef = 0;
-    Lit lastUndef = lit_Undef;
-    for (const Lit
-        *it = cl->begin(), *end = cl->end()
+/**
+@brief Value the var had in the last sweep just before step "at" was processed
+*/
+lbool SolutionExtender::prevValueBefore(const Var var, const uint32_t at) const
+{
+    const vector<uint32_t>::const_iterator start = blk.begin() + blkStart[var];
+    const vector<uint32_t>::const_iterator end = blk.begin() + blkStart[var+1];
+    for(vector<uint32_t>::const_iterator
+        it = std::upper_bound(start, end, at)
         ; it != end
         ; it++
     ) {
-        if (value(*it) == l_True) return true;
-        if (value(*it) == l_False) continue;
+        if (prevFlip[*it]) {
+            return boolToLBool(!stepBlockedOn[*it].sign());
+        }
+    }
 
-        assert(value(*it) == l_Undef);
-        numUndef++;
+    return prevDefault[var];
+}
 
-        //Doesn't propagate anything
-        if (numUndef > 1)
-            break;
+/**
+@brief Var's value differs from that of the last sweep at steps below "below"
+*/
+void SolutionExtender::markDiff(const Var var, const uint32_t below)
+{
+    if (diff[var])
+        return;
 
-        lastUndef = *it;
+    diff[var] = true;
+    touched.push_back(var);
+    for(uint32_t i = occStart[var]; i < occStart[var+1] && occ[i] < below; i++) {
+        toVisit.push(occ[i]);
     }
+}
 
-    //Must set this one value
-    if (numUndef == 1) {
-        #ifdef VERBOSE_DEBUG_RECONSTRUCT
-        cout << "c Due to cl " << *cl << " propagate enqueueing " << lastUndef << endl;
-        #endif
-        enqueue(lastUndef);
-    }
+/**
+@brief Re-evaluates only the steps that have a variable with a changed value
 
-    if (numUndef >= 1)
-        return true;
+diff[var] is set if, at the current point of the sweep, the var's value is
+different from the last sweep at the same point. In that case the value is
+in cur[var]. Otherwise the value is recovered from the last sweep.
+*/
+void SolutionExtender::incrementalSweep()
+{
+    runStats.numIncremental++;
+    const uint32_t numSteps = stepBlockedOn.size();
+    assert(toVisit.empty());
+    touched.clear();
+    flipChanged.clear();
+
+    cur.resize(solver->nVarsReal());
+    for(Var var = 0; var < solver->nVarsReal(); var++) {
+        if (defaults[var] != prevDefault[var]) {
+            cur[var] = defaults[var];
+            markDiff(var, numSteps);
+        }
+    }
 
-    //Must flip
-    #ifdef VERBOSE_DEBUG_RECONSTRUCT
-    cout
-    << "Flipping lit " << blockedOn
-    << " due to clause " << *cl << endl;
-    #endif
-    assert(blockedOn != lit_Undef);
+    uint32_t last = std::numeric_limits<uint32_t>::max();
+    while(!toVisit.empty()) {
+        const uint32_t i = toVisit.top();
+        toVisit.pop();
+        if (i == last)
+            continue;
+        last = i;
+        runStats.stepsVisited++;
+
+        bool sat = false;
+        for(uint32_t at = stepStart[i]; at < stepStart[i+1] && !sat; at++) {
+            const Lit lit = stepLits[at];
+            const lbool val = diff[lit.var()]
+                ? cur[lit.var()] : prevValueBefore(lit.var(), i);
+            sat = ((val ^ lit.sign()) == l_True);
+        }
+        const bool flip = !sat;
+        if (flip != (bool)prevFlip[i]) {
+            flipChanged.push_back(i);
+            if (flip)
+                runStats.flips++;
+        }
 
-    if (solver->varData[blockedOn.var()].level == 0) {
-        cout
-        << "!! Flip 0-level var:"
-        << solver->interToOuterMain[blockedOn.var()]
-        << endl;
+        //Value of the blocked var after this step, now and in last sweep
+        const Lit blockedOn = stepBlockedOn[i];
+        const Var var = blockedOn.var();
+        const lbool prevBefore = prevValueBefore(var, i);
+        const lbool before = diff[var] ? cur[var] : prevBefore;
+        const lbool after = flip ? boolToLBool(!blockedOn.sign()) : before;
+        const lbool prevAfter = prevFlip[i] ? boolToLBool(!blockedOn.sign()) : prevBefore;
+        if (after != prevAfter) {
+            cur[var] = after;
+            markDiff(var, i);
+        } else {
+            diff[var] = false;
+        }
     }
+    runStats.stepsTotal += numSteps;
 
-    assert(
-        (solver->varData[blockedOn.var()].level != 0
-            //|| solver->varData[blockedOn.var()].removed == Removed::decomposed
-        )
-        && "We cannot flip 0-level vars"
-    );
-    enqueue(blockedOn);
-    replaceSet(blockedOn);
-    return true;
+    //Make this sweep the last sweep
+    for(vector<uint32_t>::const_iterator
+        it = flipChanged.begin(), end = flipChanged.end()
+        ; it != end
+        ; it++
+    ) {
+        prevFlip[*it] = !prevFlip[*it];
+    }
+    for(vector<Var>::const_iterator
+        it = touched.begin(), end = touched.end()
+        ; it != end
+        ; it++
+    ) {
+        if (diff[*it]) {
+            prevFinal[*it] = cur[*it];
+            diff[*it] = false;
+        }
+    }
+    prevDefault = defaults;
 }
 
-void SolutionExtender::enqueue(const Lit lit)
-{
-    assigns[lit.var()] = boolToLBool(!lit.sign());
-    trail.push_back(lit);
-    #ifdef VERBOSE_DEBUG_RECONSTRUCT
-    cout << "c Enqueueing lit " << lit << " during solution reconstruction" << endl;
-    #endif
-    solver->varData[lit.var()].level = std::numeric_limits< uint32_t >::max();
-}
+/**
+@brief Only evaluates steps that can influence the projected variables
 
-void SolutionExtender::replaceSet(Lit toSet)
+A step is needed if it is blocked on a needed var. Then all vars of the step
+are needed, but only at the point of the step, so only steps above it.
+*/
+void SolutionExtender::projectedSweep()
 {
-    //set forward equivalent
-    if (solver->varReplacer->isReplaced(toSet)) {
-        toSet = solver->varReplacer->getLitReplacedWith(toSet);
-        enqueue(toSet);
+    runStats.numProjected++;
+    const uint32_t numSteps = stepBlockedOn.size();
+    needed.assign(solver->nVarsReal(), false);
+    inProjection.assign(solver->nVarsReal(), false);
+    for(vector<Var>::const_iterator
+        it = projection.begin(), end = projection.end()
+        ; it != end
+        ; it++
+    ) {
+        if (*it >= solver->nVarsReal()) {
+            cout
+            << "ERROR: projection var " << *it + 1
+            << " does not exist"
+            << endl;
+            exit(-1);
+        }
+        const Var rep = alias[*it].var();
+        needed[rep] = true;
+        inProjection[rep] = true;
+    }
+
+    stepNeeded.assign(numSteps, false);
+    for(uint32_t i = 0; i < numSteps; i++) {
+        if (!needed[stepBlockedOn[i].var()])
+            continue;
+
+        stepNeeded[i] = true;
+        for(uint32_t at = stepStart[i]; at < stepStart[i+1]; at++) {
+            needed[stepLits[at].var()] = true;
+        }
     }
-    replaceBackwardSet(toSet);
 
-    #ifdef VERBOSE_DEBUG_RECONSTRUCT
-    cout << "c recursive set(s) done." << endl;
-    #endif
+    cur = defaults;
+    for(uint32_t i = numSteps; i > 0;) {
+        i--;
+        if (!stepNeeded[i])
+            continue;
+
+        runStats.stepsVisited++;
+        if (!stepSatisfied(i)) {
+            const Lit blockedOn = stepBlockedOn[i];
+            cur[blockedOn.var()] = boolToLBool(!blockedOn.sign());
+            runStats.flips++;
+        }
+    }
+    runStats.stepsTotal += numSteps;
 }
 
-void SolutionExtender::replaceBackwardSet(const Lit toSet)
-{
-    //set backward equiv
-    map<Var, vector<Var> >::const_iterator revTable = solver->varReplacer->getReverseTable().find(toSet.var());
-    if (revTable != solver->varReplacer->getReverseTable().end()) {
-        const vector<Var>& toGoThrough = revTable->second;
-        for (size_t i = 0; i < toGoThrough.size(); i++) {
-            //Get sign of replacement
-            const Lit lit = Lit(toGoThrough[i], false);
-            Lit tmp = solver->varReplacer->getLitReplacedWith(lit);
-
-            //Set var
-            enqueue(lit ^ tmp.sign() ^ toSet.sign());
+/**
+@brief Copies the values of the representatives to solver->model
+
+If onlyThese is given, eliminated vars whose representative is not in it are
+left l_Undef
+*/
+void SolutionExtender::fillModel(
+    const vector<lbool>& vals
+    , const vector<lbool>& solution
+    , const vector<char>* onlyThese
+) {
+    solver->model.resize(solver->nVarsReal());
+    for(Var inter = 0; inter < solver->nVarsReal(); inter++) {
+        const Lit rep = alias[solver->interToOuterMain[inter]];
+        if (onlyThese != NULL
+            && !(*onlyThese)[rep.var()]
+            && solution[solver->outerToInterMain[rep.var()]] == l_Undef
+        ) {
+            solver->model[inter] = l_Undef;
+            continue;
         }
+
+        solver->model[inter] = vals[rep.var()] ^ rep.sign();
     }
 }
+
+uint64_t SolutionExtender::memUsed() const
+{
+    uint64_t mem = 0;
+    mem += alias.capacity()*sizeof(Lit);
+    mem += stepLits.capacity()*sizeof(Lit);
+    mem += stepStart.capacity()*sizeof(uint32_t);
+    mem += stepBlockedOn.capacity()*sizeof(Lit);
+    mem += occStart.capacity()*sizeof(uint32_t);
+    mem += occ.capacity()*sizeof(uint32_t);
+    mem += blkStart.capacity()*sizeof(uint32_t);
+    mem += blk.capacity()*sizeof(uint32_t);
+    mem += prevDefault.capacity()*sizeof(lbool);
+    mem += prevFinal.capacity()*sizeof(lbool);
+    mem += prevFlip.capacity()*sizeof(char);
+    mem += defaults.capacity()*sizeof(lbool);
+    mem += cur.capacity()*sizeof(lbool);
+    mem += diff.capacity()*sizeof(char);
+    mem += touched.capacity()*sizeof(Var);
+    mem += flipChanged.capacity()*sizeof(uint32_t);
+    mem += needed.capacity()*sizeof(char);
+    mem += inProjection.capacity()*sizeof(char);
+    mem += stepNeeded.capacity()*sizeof(char);
+
+    return mem;
+}
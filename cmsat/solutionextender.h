@@ -19,7 +19,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define __SOLUTIONEXTENDER_H__
 
 #include "solvertypes.h"
-#include "clause.h"
+#include <vector>
+#include <queue>
 
 namespace CMSat {
 
@@ -28,58 +29,209 @@ namespace CMSat {
 #endif
 
 class Solver;
+using std::vector;
 
+/**
+@brief Extends the solution of the simplified problem to the original problem
+
+The blocked clauses of the Simplifier are compiled (once per change of the
+blocked clause stack) into a flat list of steps, in OUTER numbering, with
+every variable mapped to its representative in the VarReplacer. Extension is
+then a single reverse sweep over these steps: if a step's clause is not
+satisfied, its blocked literal is flipped.
+
+The result of the last sweep is kept. If the next solution only differs in a
+few variables, only the steps that contain variables whose value differs
+from the last sweep are re-evaluated.
+
+If a projection is set, only the steps that can influence the projected
+variables are evaluated, and all other eliminated variables are left l_Undef
+*/
 class SolutionExtender
 {
     public:
-        SolutionExtender(Solver* _solver, const vector<lbool>& _assigns);
-        void extend();
-        bool addClause(const vector<Lit>& lits, const Lit blockedOn = lit_Undef);
-        void enqueue(const Lit lit);
+        SolutionExtender(Solver* _solver);
 
-        lbool value(const Lit lit) const
-        {
-            return assigns[lit.var()] ^ lit.sign();
-        }
+        //Extend solution (internal numbering) into solver->model
+        void extend(const vector<lbool>& solution);
 
-        lbool value(const Var var) const
-        {
-            return assigns[var];
-        }
+        //Projection, in outer numbering. Empty means everything
+        void setProjection(const vector<Var>& outerVars);
+        const vector<Var>& getProjection() const;
 
-    private:
-        void replaceSet(Lit toSet);
-        void replaceBackwardSet(const Lit toSet);
-        bool propagateCl(const Clause* cl, const Lit blockedOn);
-        bool propagate();
-        bool propBinaryClause(
-            const vec<Watched>::const_iterator i
-            , const Lit p
-        );
-        bool propTriClause(
-            const vec<Watched>::const_iterator i
-            , const Lit p
-        );
-        bool satisfiedNorm(const vector<Lit>& lits) const;
-        bool satisfiedXor(const vector<Lit>& lits, const bool rhs) const;
-        Lit pickBranchLit();
+        uint64_t memUsed() const;
 
-        uint32_t nVarsReal() const
+        struct Stats
         {
-            return assigns.size();
-        }
+            Stats() :
+                numCalls(0)
+                , numFull(0)
+                , numIncremental(0)
+                , numProjected(0)
+                , numCompiles(0)
+                , stepsTotal(0)
+                , stepsVisited(0)
+                , flips(0)
+                , cpu_time(0)
+            {}
+
+            void clear()
+            {
+                Stats tmp;
+                *this = tmp;
+            }
+
+            Stats& operator+=(const Stats& other)
+            {
+                numCalls += other.numCalls;
+                numFull += other.numFull;
+                numIncremental += other.numIncremental;
+                numProjected += other.numProjected;
+                numCompiles += other.numCompiles;
+                stepsTotal += other.stepsTotal;
+                stepsVisited += other.stepsVisited;
+                flips += other.flips;
+                cpu_time += other.cpu_time;
+
+                return *this;
+            }
+
+            void print() const
+            {
+                cout << "c -------- SOLUTION EXTEND STATS --------" << endl;
+                printStatsLine("c time"
+                    , cpu_time
+                    , cpu_time/(double)numCalls
+                    , "per call"
+                );
+
+                printStatsLine("c full/incr/proj"
+                    , numFull
+                    , numIncremental
+                    , numProjected
+                );
+
+                printStatsLine("c compiles"
+                    , numCompiles
+                );
+
+                printStatsLine("c steps visited"
+                    , stepsVisited
+                    , 100.0*(double)stepsVisited/(double)stepsTotal
+                    , "% of all steps"
+                );
+
+                printStatsLine("c flips"
+                    , flips
+                    , (double)flips/(double)numCalls
+                    , "per call"
+                );
+                cout << "c -------- SOLUTION EXTEND STATS END --------" << endl;
+            }
+
+            void printShort() const
+            {
+                cout
+                << "c [extend]"
+                << " visited: " << stepsVisited << "/" << stepsTotal
+                << " flips: " << flips
+                << " T: " << std::fixed << std::setprecision(2)
+                << cpu_time << " s"
+                << endl;
+            }
+
+            uint64_t numCalls;
+            uint64_t numFull;
+            uint64_t numIncremental;
+            uint64_t numProjected;
+            uint64_t numCompiles;
+            uint64_t stepsTotal;
+            uint64_t stepsVisited;
+            uint64_t flips;
+            double cpu_time;
+        };
+        const Stats& getStats() const;
 
-        //To reduce mem alloc overhead
-        vector<Lit> tmpLits;
+    private:
+        Solver* solver;
 
+        //Compiled steps
+        void compileIfNeeded();
+        void buildAlias();
+        void compileSteps();
+        bool stepSatisfied(const uint32_t at) const;
+        lbool outerValue(const Lit lit) const;
+
+        //Sweeps
+        void calcDefaults(const vector<lbool>& solution);
+        void fullSweep();
+        void incrementalSweep();
+        void projectedSweep();
+        lbool prevValueBefore(const Var var, const uint32_t at) const;
+        void markDiff(const Var var, const uint32_t below);
+        void fillModel(
+            const vector<lbool>& vals
+            , const vector<lbool>& solution
+            , const vector<char>* onlyThese
+        );
 
-        Solver* solver;
-        vector<ClOffset> clausesToFree;
-        uint32_t qhead;
-        vector<Lit> trail;
-        vector<lbool> assigns;
+        ///Outer var -> representative literal (outer)
+        vector<Lit> alias;
+
+        ///Literals of the steps, flattened. Step i is at stepStart[i]..stepStart[i+1]
+        vector<Lit> stepLits;
+        vector<uint32_t> stepStart;
+        vector<Lit> stepBlockedOn;
+
+        ///Rep var -> steps containing it, ascending. Same flattening as steps
+        vector<uint32_t> occStart;
+        vector<uint32_t> occ;
+
+        ///Rep var -> steps blocked on it, ascending
+        vector<uint32_t> blkStart;
+        vector<uint32_t> blk;
+
+        //What the compiled steps correspond to
+        bool compiled;
+        uint64_t compiledGen;
+        size_t compiledNumBlocked;
+        size_t compiledNumReplaced;
+        size_t compiledNumVars;
+
+        //Result of last full or incremental sweep
+        bool havePrev;
+        vector<lbool> prevDefault;
+        vector<lbool> prevFinal;
+        vector<char> prevFlip;
+
+        //Temporaries of the sweeps, all indexed by outer var
+        vector<lbool> defaults;
+        vector<lbool> cur;
+        vector<char> diff;
+        vector<Var> touched;
+        vector<uint32_t> flipChanged;
+        std::priority_queue<uint32_t> toVisit;
+
+        //Projection
+        vector<Var> projection;
+        vector<char> inProjection;
+        vector<char> needed;
+        vector<char> stepNeeded;
+
+        Stats runStats;
+        Stats globalStats;
 };
 
+inline const vector<Var>& SolutionExtender::getProjection() const
+{
+    return projection;
+}
+
+inline const SolutionExtender::Stats& SolutionExtender::getStats() const
+{
+    return globalStats;
+}
+
 } //end namespace
 
 #endif //__SOLUTIONEXTENDER_H__
@@ -34,10 +34,17 @@
 #include "sqlstats.h"
 #include <fstream>
 #include <cmath>
+#include <cstring>
 #include <fcntl.h>
 #include "completedetachreattacher.h"
 #include "compfinder.h"
 #include "comphandler.h"
+#include "taskpool.h"
+#include "shareddata.h"
+#include "clausespill.h"
+#include "localsearch.h"
+#include "cardfinder.h"
+#include "sweeper.h"
 #include "varupdatehelper.h"
 
 using namespace CMSat;
@@ -68,7 +75,14 @@ Solver::Solver(const SolverConf& _conf) :
     , clauseCleaner(NULL)
     , varReplacer(NULL)
     , compHandler(NULL)
+    , solutionExtender(NULL)
+    , taskPool(NULL)
+    , clauseSpill(NULL)
+    , localSearch(NULL)
+    , cardFinder(NULL)
+    , sweeper(NULL)
     , mtrand(_conf.origSeed)
+    , numBvaVars(0)
     , needToInterrupt(false)
 
     //Stuff
@@ -76,6 +90,12 @@ Solver::Solver(const SolverConf& _conf) :
     , numDecisionVars(0)
     , zeroLevAssignsByCNF(0)
     , zeroLevAssignsByThreads(0)
+    , lastCleanZeroDepthAssigns(std::numeric_limits<size_t>::max())
+    , shared(NULL)
+    , threadNum(0)
+    , nextSyncConfl(0)
+    , numImportedUnits(0)
+    , numImportedBins(0)
 {
     if (conf.doSQL) {
         #ifdef USE_MYSQL
@@ -107,12 +127,24 @@ Solver::Solver(const SolverConf& _conf) :
     if (conf.doCompHandler) {
         compHandler = new CompHandler(this);
     }
+    solutionExtender = new SolutionExtender(this);
+    taskPool = new TaskPool(conf.numThreads);
+    clauseSpill = new ClauseSpill(this);
+    localSearch = new LocalSearch(this);
+    cardFinder = new CardFinder(this);
+    sweeper = new Sweeper(this);
     Searcher::solver = this;
 }
 
 Solver::~Solver()
 {
     delete compHandler;
+    delete solutionExtender;
+    delete taskPool;
+    delete clauseSpill;
+    delete localSearch;
+    delete cardFinder;
+    delete sweeper;
     delete sqlStats;
     delete prober;
     delete simplifier;
@@ -129,6 +161,7 @@ bool Solver::addXorClause(const vector<Var>& vars, bool rhs)
     for(size_t i = 0; i < vars.size(); i++) {
         ps[i] = Lit(vars[i], false);
     }
+    outsideToOuter(ps);
 
     if (!addClauseHelper(ps))
         return false;
@@ -618,6 +651,17 @@ it acts on them such that they are correct, and calls addClauseInt() to do
 the heavy-lifting
 */
 bool Solver::addClause(const vector<Lit>& lits)
+{
+    vector<Lit> ps = lits;
+    outsideToOuter(ps);
+
+    return addClauseOuter(ps);
+}
+
+/**
+@brief Same as addClause(), but with outer literals, i.e. may contain BVA vars
+*/
+bool Solver::addClauseOuter(const vector<Lit>& lits)
 {
     if (conf.doSimplify && simplifier->getAnythingHasBeenBlocked()) {
         cout
@@ -693,6 +737,7 @@ bool Solver::addLearntClause(
 ) {
     vector<Lit> ps(lits.size());
     std::copy(lits.begin(), lits.end(), ps.begin());
+    outsideToOuter(ps);
 
     if (!addClauseHelper(ps))
         return false;
@@ -790,7 +835,8 @@ void Solver::renumberVariables()
     outerToInter.resize(nVarsReal());
     size_t at = 0;
     vector<Var> useless;
-    size_t numEffectiveVars = 0;
+    vector<Var> order;
+    vector<char> active(nVars(), 0);
     for(size_t i = 0; i < nVars(); i++) {
         if (value(i) != l_Undef
             || varData[i].removed == Removed::elimed
@@ -801,10 +847,24 @@ void Solver::renumberVariables()
             continue;
         }
 
-        outerToInter[i] = at;
-        interToOuter[at] = i;
+        active[i] = true;
+        order.push_back(i);
+    }
+    const size_t numEffectiveVars = order.size();
+
+    if (conf.doRenumberLocality) {
+        calcLocalityOrder(active, order);
+        assert(order.size() == numEffectiveVars);
+    }
+
+    for(vector<Var>::const_iterator
+        it = order.begin(), end = order.end()
+        ; it != end
+        ; it++
+    ) {
+        outerToInter[*it] = at;
+        interToOuter[at] = *it;
         at++;
-        numEffectiveVars++;
     }
 
     //Fill the rest with variables that have been removed/eliminated/set
@@ -962,6 +1022,96 @@ void Solver::renumberVariables()
     redoOrderHeap();
 }
 
+/**
+@brief Orders the active vars so that the ones sharing clauses are close
+
+Breadth-first search over the irredundant clauses, started from the first
+unvisited var of the current order. The vars that propagate each other then
+sit next to each other in the per-var arrays and the watchlists. A long clause
+is only expanded once, when the first of its vars is reached, so this is linear
+in the size of the irredundant clauses.
+*/
+void Solver::calcLocalityOrder(const vector<char>& active, vector<Var>& order) const
+{
+    //Occurrence lists of the long irredundant clauses, by var
+    vector<uint32_t> occStart(nVars()+1, 0);
+    for(ClOffset offset: longIrredCls) {
+        const Clause& cl = *clAllocator->getPointer(offset);
+        for(const Lit lit: cl) {
+            occStart[lit.var()+1]++;
+        }
+    }
+    for(size_t i = 0; i < nVars(); i++) {
+        occStart[i+1] += occStart[i];
+    }
+    vector<uint32_t> occ(occStart[nVars()]);
+    vector<uint32_t> at(occStart.begin(), occStart.end()-1);
+    for(size_t i = 0; i < longIrredCls.size(); i++) {
+        const Clause& cl = *clAllocator->getPointer(longIrredCls[i]);
+        for(const Lit lit: cl) {
+            occ[at[lit.var()]++] = i;
+        }
+    }
+
+    vector<char> visited(nVars(), 0);
+    vector<char> clDone(longIrredCls.size(), 0);
+    const size_t numActive = order.size();
+    vector<Var> origOrder;
+    origOrder.swap(order);
+    order.reserve(numActive);
+    for(const Var start: origOrder) {
+        if (visited[start])
+            continue;
+
+        visited[start] = true;
+        order.push_back(start);
+        for(size_t head = order.size()-1; head < order.size(); head++) {
+            const Var var = order[head];
+
+            //Implicit clauses
+            for(int sign = 0; sign < 2; sign++) {
+                const vec<Watched>& ws = watches[Lit(var, sign).toInt()];
+                for(vec<Watched>::const_iterator
+                    it = ws.begin(), end = ws.end()
+                    ; it != end
+                    ; it++
+                ) {
+                    if (it->isClause() || it->learnt())
+                        continue;
+
+                    const Var var2 = it->lit2().var();
+                    if (active[var2] && !visited[var2]) {
+                        visited[var2] = true;
+                        order.push_back(var2);
+                    }
+                    if (it->isTri()) {
+                        const Var var3 = it->lit3().var();
+                        if (active[var3] && !visited[var3]) {
+                            visited[var3] = true;
+                            order.push_back(var3);
+                        }
+                    }
+                }
+            }
+
+            //Long clauses
+            for(uint32_t i = occStart[var]; i < occStart[var+1]; i++) {
+                if (clDone[occ[i]])
+                    continue;
+
+                clDone[occ[i]] = true;
+                const Clause& cl = *clAllocator->getPointer(longIrredCls[occ[i]]);
+                for(const Lit lit: cl) {
+                    if (active[lit.var()] && !visited[lit.var()]) {
+                        visited[lit.var()] = true;
+                        order.push_back(lit.var());
+                    }
+                }
+            }
+        }
+    }
+}
+
 void Solver::saveVarMem(const uint32_t newNumVars)
 {
     //never resize varData --> contains info about what is replaced/etc.
@@ -980,6 +1130,7 @@ void Solver::saveVarMem(const uint32_t newNumVars)
     seen.shrink_to_fit();
     seen2.resize(newNumVars*2);
     seen2.shrink_to_fit();
+    taskPool->newNumVars(newNumVars);
 
     activities.resize(newNumVars);
     activities.shrink_to_fit();
@@ -999,6 +1150,7 @@ void Solver::unSaveVarMem()
     //Resize 'seen'
     seen.resize(nVarsReal()*2);
     seen2.resize(nVarsReal()*2);
+    taskPool->newNumVars(nVarsReal());
 
     activities.resize(nVarsReal());
     minNumVars = nVarsReal();
@@ -1006,7 +1158,53 @@ void Solver::unSaveVarMem()
     //printMemStats();
 }
 
+/**
+@brief New variable from the user. Returns its outside number
+*/
 Var Solver::newVar(const bool dvar)
+{
+    const Var outer = newVarInt(dvar);
+    outerToOutsideMain.push_back(outsideToOuterMain.size());
+    outsideToOuterMain.push_back(outer);
+
+    return outsideToOuterMain.size()-1;
+}
+
+/**
+@brief New variable for BVA. The user never sees it, it's not in the model
+*/
+Var Solver::newBvaVar()
+{
+    const Var var = newVarInt(true);
+    outerToOutsideMain.push_back(var_Undef);
+    numBvaVars++;
+
+    return var;
+}
+
+/**
+@brief Maps the literals from outside numbering to outer numbering
+*/
+void Solver::outsideToOuter(vector<Lit>& ps) const
+{
+    //Without BVA variables, the two are the same
+    if (numBvaVars == 0)
+        return;
+
+    for (Lit& lit: ps) {
+        if (lit.var() >= nVarsOutside()) {
+            cout
+            << "ERROR: Variable " << lit.var() + 1
+            << " inserted, but max var is "
+            << nVarsOutside()
+            << endl;
+            exit(-1);
+        }
+        lit = Lit(outsideToOuterMain[lit.var()], lit.sign());
+    }
+}
+
+Var Solver::newVarInt(const bool dvar)
 {
     //For adding the variable to all sorts of places, we need to increment
     //the sizes of the vectors/heaps
@@ -1083,111 +1281,66 @@ Var Solver::newVar(const bool dvar)
     if (conf.doCompHandler) {
         compHandler->newVar();
     }
+    taskPool->newNumVars(nVarsReal());
 
     return decisionVar.size()-1;
 }
 
 /// @brief Sort clauses according to glues: large glues first
-bool Solver::reduceDBStructGlue::operator () (
-    const ClOffset xOff
-    , const ClOffset yOff
-) {
-    //Get their pointers
-    const Clause* x = clAllocator->getPointer(xOff);
-    const Clause* y = clAllocator->getPointer(yOff);
-
-    const uint32_t xsize = x->size();
-    const uint32_t ysize = y->size();
-
-    //No clause should be less than 3-long: 2&3-long are not removed
-    assert(xsize > 2 && ysize > 2);
-
-    //First tie: glue
-    if (x->stats.glue > y->stats.glue) return 1;
-    if (x->stats.glue < y->stats.glue) return 0;
-
-    //Second tie: size
-    return xsize > ysize;
-}
-
-bool Solver::reduceDBStructActivity::operator () (
-    const ClOffset xOff
-    , const ClOffset yOff
-) {
-    //Get their pointers
-    const Clause* x = clAllocator->getPointer(xOff);
-    const Clause* y = clAllocator->getPointer(yOff);
-
-    const uint32_t xsize = x->size();
-    const uint32_t ysize = y->size();
-
-    //No clause should be less than 3-long: 2&3-long are not removed
-    assert(xsize > 2 && ysize > 2);
-
-    //First tie: activity
-    if (x->stats.activity < y->stats.activity) return 1;
-    if (x->stats.activity > y->stats.activity) return 0;
-
-    //Second tie: size
-    return xsize > ysize;
-}
-
-
-/// @brief Sort clauses according to size: large sizes first
-bool Solver::reduceDBStructSize::operator () (
-    const ClOffset xOff
-    , const ClOffset yOff
-) {
-    //Get their pointers
-    const Clause* x = clAllocator->getPointer(xOff);
-    const Clause* y = clAllocator->getPointer(yOff);
-
-    const uint32_t xsize = x->size();
-    const uint32_t ysize = y->size();
+/**
+@brief Key of a local learnt clause for cleaning: the lower, the sooner removed
 
+Packs the order of clauseCleaningType into a single integer, so ranking does
+not need to dereference the clauses
+*/
+uint64_t Solver::cleaningKey(const Clause* cl) const
+{
     //No clause should be less than 3-long: 2&3-long are not removed
-    assert(xsize > 2 && ysize > 2);
-
-    //First tie: size
-    if (xsize > ysize) return 1;
-    if (xsize < ysize) return 0;
-
-    //Second tie: glue
-    return x->stats.glue > y->stats.glue;
-}
+    assert(cl->size() > 2);
 
-/// @brief Sort clauses according to size: small prop+confl first
-bool Solver::reduceDBStructPropConfl::operator() (
-    const ClOffset xOff
-    , const ClOffset yOff
-) {
-    //Get their pointers
-    const Clause* x = clAllocator->getPointer(xOff);
-    const Clause* y = clAllocator->getPointer(yOff);
-
-    const uint32_t xsize = x->size();
-    const uint32_t ysize = y->size();
+    //Larger sizes and glues are worse
+    const uint64_t size = 0xffffULL - cl->size();
+    const uint64_t glue = 0xffffULL - cl->stats.glue;
 
-    //No clause should be less than 3-long: 2&3-long are not removed
-    assert(xsize > 2 && ysize > 2);
+    switch (conf.clauseCleaningType) {
+        case CLEAN_CLAUSES_GLUE_BASED :
+            return (glue << 16) | size;
 
-    //First tie: numPropAndConfl -- notice the reversal of 1/0
-    //Larger is better --> should be last in the sorted list
-    if (x->stats.numPropAndConfl() != y->stats.numPropAndConfl())
-        return (x->stats.numPropAndConfl() < y->stats.numPropAndConfl());
+        case CLEAN_CLAUSES_SIZE_BASED :
+            return (size << 16) | glue;
+
+        case CLEAN_CLAUSES_ACTIVITY_BASED : {
+            //Activities are kept below 1e20, and the float bits of a
+            //non-negative number order the same way as the number
+            const float act = cl->stats.activity;
+            uint32_t actBits;
+            memcpy(&actBits, &act, sizeof(actBits));
+            return ((uint64_t)actBits << 16) | size;
+        }
 
-    //Second tie: size
-    if (x->stats.numUsedUIP != y->stats.numUsedUIP)
-        return x->stats.numUsedUIP < y->stats.numUsedUIP;
+        case CLEAN_CLAUSES_PROPCONFL_BASED : {
+            const uint64_t propConfl = std::min<uint64_t>(cl->stats.numPropAndConfl(), 0xffffffULL);
+            const uint64_t usedUIP = std::min<uint64_t>(cl->stats.numUsedUIP, 0xffffffULL);
+            return (propConfl << 40) | (usedUIP << 16) | size;
+        }
+    }
 
-    return x->size() > y->size();
+    assert(false);
+    return 0;
 }
 
 /**
 @brief Removes learnt clauses that have been found not to be too good
 
-Either based on glue or MiniSat-style learnt clause activities, the clauses are
-sorted and then removed
+Learnt clauses are in three tiers according to their glue:
+- core clauses (glue <= glueCoreMax) are never removed
+- tier2 clauses (glue <= glueTier2Max) are kept as long as they are used
+between two cleanings. Once unused, they are demoted to local for good
+- local clauses are ranked according to clauseCleaningType, and the worst
+ones are removed
+
+The ranking key of every local clause is computed once, and the worst ones are
+selected with nth_element instead of sorting everything
 */
 CleaningStats Solver::reduceDB()
 {
@@ -1200,205 +1353,140 @@ CleaningStats Solver::reduceDB()
     CleaningStats tmpStats;
     tmpStats.origNumClauses = longRedCls.size();
     tmpStats.origNumLits = binTri.redLits - binTri.redBins*2;
-
-    //Calculate how many to remove
-    uint64_t origRemoveNum = (double)longRedCls.size() *conf.ratioRemoveClauses;
-
-    //If there is a ratio limit, and we are over it
-    //then increase the removeNum accordingly
-    uint64_t maxToHave = (double)(longIrredCls.size() + binTri.irredTris + nVars() + 300ULL)
-        * (double)solveStats.nbReduceDB
-        * conf.maxNumLearntsRatio;
-    uint64_t removeNum = std::max<long long>(origRemoveNum, (long)longRedCls.size()-(long)maxToHave);
-
-    if (removeNum != origRemoveNum) {
-        if (conf.verbosity >= 2) {
-            cout
-            << "c [DBclean] Hard upper limit reached, removing more than normal: "
-            << origRemoveNum << " --> " << removeNum
-            << endl;
-        }
-    } else {
-        if (conf.verbosity >= 2) {
-        cout
-        << "c [DBclean] Hard limit would be: " << maxToHave
-        << endl;
-        }
-    }
-
-    //Subsume
-    uint64_t sumConfl = sumConflicts();
-    //simplifier->subsumeLearnts();
-    if (conf.verbosity >= 3) {
-        cout
-        << "c Time wasted on clean&replace&sub: "
-        << std::setprecision(3) << cpuTime()-myTime
-        << endl;
-    }
-
-    //Complete detach&reattach of OK clauses will be *much* faster
-    CompleteDetachReatacher detachReattach(this);
-    detachReattach.detachNonBinsNonTris();
-
-    //pre-remove
-    if (conf.doPreClauseCleanPropAndConfl) {
-        //Reduce based on props&confls
-        size_t i, j;
-        for (i = j = 0; i < longRedCls.size(); i++) {
-            ClOffset offset = longRedCls[i];
-            Clause* cl = clAllocator->getPointer(offset);
-            assert(cl->size() > 3);
-            if (cl->stats.numPropAndConfl() < conf.preClauseCleanLimit
-                && cl->stats.conflictNumIntroduced + conf.preCleanMinConflTime
-                    < sumStats.conflStats.numConflicts
-            ) {
-                //Stat update
-                tmpStats.preRemove.incorporate(cl);
-                tmpStats.preRemove.age += sumConfl - cl->stats.conflictNumIntroduced;
-
-                //Check
-                assert(cl->stats.conflictNumIntroduced <= sumConfl);
-
-                if (cl->stats.glue > cl->size() + 1000) {
-                    cout
-                    << "c DEBUG strangely large glue: " << *cl
-                    << " glue: " << cl->stats.glue
-                    << " size: " << cl->size()
-                    << endl;
-                }
-
-                //detach&free
-                #ifdef DRUP
-                if (drup) {
-                    (*drup)
-                    << "d "
-                    << *cl
-                    << " 0\n";
-                }
-                #endif
-                clAllocator->clauseFree(offset);
-
-            } else {
-                longRedCls[j++] = offset;
-            }
-        }
-        longRedCls.resize(longRedCls.size() -(i-j));
-    }
-
-    //Clean according to type
     tmpStats.clauseCleaningType = conf.clauseCleaningType;
     switch (conf.clauseCleaningType) {
         case CLEAN_CLAUSES_GLUE_BASED :
-            //Sort for glue-based removal
-            std::sort(longRedCls.begin(), longRedCls.end()
-                , reduceDBStructGlue(clAllocator));
             tmpStats.glueBasedClean = 1;
             break;
 
         case CLEAN_CLAUSES_SIZE_BASED :
-            //Sort for glue-based removal
-            std::sort(longRedCls.begin(), longRedCls.end()
-                , reduceDBStructSize(clAllocator));
             tmpStats.sizeBasedClean = 1;
             break;
 
         case CLEAN_CLAUSES_ACTIVITY_BASED :
-            //Sort for glue-based removal
-            std::sort(longRedCls.begin(), longRedCls.end()
-                , reduceDBStructActivity(clAllocator));
             tmpStats.actBasedClean = 1;
             break;
 
         case CLEAN_CLAUSES_PROPCONFL_BASED :
-            //Sort for glue-based removal
-            std::sort(longRedCls.begin(), longRedCls.end()
-                , reduceDBStructPropConfl(clAllocator));
             tmpStats.propConflBasedClean = 1;
             break;
     }
+    const uint64_t sumConfl = sumConflicts();
 
-    #ifdef VERBOSE_DEBUG
-    cout << "Cleaning learnt clauses. Learnt clauses after sort: " << endl;
-    for (uint32_t i = 0; i != longRedCls.size(); i++) {
-        const Clause* cl = clAllocator->getPointer(longRedCls[i]);
-        cout << *cl << endl;
-    }
-    #endif
+    //Complete detach&reattach of OK clauses will be *much* faster
+    CompleteDetachReatacher detachReattach(this);
+    detachReattach.detachNonBinsNonTris();
 
-    //Remove clauses
+    //Keep core and used tier2, rank the rest
+    const double selectTime = cpuTime();
+    cleanKeys.clear();
     size_t i, j;
-    for (i = j = 0
-        ; i < longRedCls.size() && tmpStats.removed.num < removeNum
-        ; i++
-    ) {
-        ClOffset offset = longRedCls[i];
+    for (i = j = 0; i < longRedCls.size(); i++) {
+        const ClOffset offset = longRedCls[i];
         Clause* cl = clAllocator->getPointer(offset);
         assert(cl->size() > 3);
+        assert(cl->stats.conflictNumIntroduced <= sumConfl);
 
-        //Don't delete if not aged long enough
-        if (cl->stats.conflictNumIntroduced + 1000
-             >= Searcher::sumConflicts()
-        ) {
+        if (cl->stats.glue <= conf.glueCoreMax) {
+            tmpStats.core.incorporate(cl);
             longRedCls[j++] = offset;
-            tmpStats.remain.incorporate(cl);
-            tmpStats.remain.age += sumConfl - cl->stats.conflictNumIntroduced;
             continue;
         }
 
-        //Stats Update
-        tmpStats.removed.incorporate(cl);
-        tmpStats.removed.age += sumConfl - cl->stats.conflictNumIntroduced;
-
-        //free clause
-        #ifdef DRUP
-        if (drup) {
-            (*drup)
-            << "d "
-            << *cl
-            << " 0\n";
+        if (cl->stats.glue <= conf.glueTier2Max && !cl->getDemoted()) {
+            if (cl->stats.numPropAndConfl() + cl->stats.numUsedUIP > 0) {
+                tmpStats.tier2.incorporate(cl);
+                longRedCls[j++] = offset;
+                continue;
+            }
+            cl->setDemoted();
+            tmpStats.demoted++;
         }
-        #endif
-        clAllocator->clauseFree(offset);
-    }
 
-    //Count what is left
-    for (; i < longRedCls.size(); i++) {
-        ClOffset offset = longRedCls[i];
-        Clause* cl = clAllocator->getPointer(offset);
-
-        /*
-        //No use at all? Remove!
-        if (cl->stats.numPropAndConfl() == 0
-            && cl->stats.conflictNumIntroduced + 20000
+        //pre-remove based on props&confls
+        if (conf.doPreClauseCleanPropAndConfl
+            && cl->stats.numPropAndConfl() < conf.preClauseCleanLimit
+            && cl->stats.conflictNumIntroduced + conf.preCleanMinConflTime
                 < sumStats.conflStats.numConflicts
         ) {
-            //Stats Update
-            tmpStats.removed.incorporate(cl);
-            tmpStats.removed.age += sumConfl - cl->stats.conflictNumIntroduced;
+            tmpStats.preRemove.incorporate(cl);
+            tmpStats.preRemove.age += sumConfl - cl->stats.conflictNumIntroduced;
+            evictRedClause(offset, tmpStats);
+            continue;
+        }
 
-            //free clause
-            clAllocator->clauseFree(offset);
+        //Don't delete if not aged long enough
+        if (cl->stats.conflictNumIntroduced + 1000 >= sumConfl) {
+            tmpStats.local.incorporate(cl);
+            longRedCls[j++] = offset;
             continue;
-        }*/
+        }
 
-        //Stats Update
-        tmpStats.remain.incorporate(cl);
-        tmpStats.remain.age += sumConfl - cl->stats.conflictNumIntroduced;
+        cleanKeys.push_back(CleanKey(cleaningKey(cl), offset));
+    }
+    longRedCls.resize(j);
+    const size_t numLocal = tmpStats.local.num + cleanKeys.size();
+
+    //Calculate how many to remove
+    uint64_t origRemoveNum = (double)numLocal * conf.ratioRemoveClauses;
+
+    //If there is a ratio limit, and we are over it
+    //then increase the removeNum accordingly
+    uint64_t maxToHave = (double)(longIrredCls.size() + binTri.irredTris + nVars() + 300ULL)
+        * (double)solveStats.nbReduceDB
+        * conf.maxNumLearntsRatio;
+    const size_t numHave = longRedCls.size() + cleanKeys.size();
+    uint64_t removeNum = std::max<long long>(origRemoveNum, (long)numHave-(long)maxToHave);
 
-        if (cl->stats.conflictNumIntroduced > sumConfl) {
+    if (removeNum != origRemoveNum) {
+        if (conf.verbosity >= 2) {
             cout
-            << "c DEBUG: conflict introduction numbers are wrong."
-            << " according to CL, introduction: " << cl->stats.conflictNumIntroduced
-            << " but we think max confl: "  << sumConfl
+            << "c [DBclean] Hard upper limit reached, removing more than normal: "
+            << origRemoveNum << " --> " << removeNum
             << endl;
         }
-        assert(cl->stats.conflictNumIntroduced <= sumConfl);
+    } else {
+        if (conf.verbosity >= 2) {
+        cout
+        << "c [DBclean] Hard limit would be: " << maxToHave
+        << endl;
+        }
+    }
+
+    //Select the worst
+    removeNum = std::min<uint64_t>(removeNum, cleanKeys.size());
+    if (removeNum < cleanKeys.size()) {
+        std::nth_element(cleanKeys.begin(), cleanKeys.begin() + removeNum, cleanKeys.end());
+    }
+    tmpStats.numKeys = cleanKeys.size();
+    tmpStats.selectTime = cpuTime() - selectTime;
+
+    //Remove clauses
+    for (i = 0; i < removeNum; i++) {
+        const ClOffset offset = cleanKeys[i].offset;
+        Clause* cl = clAllocator->getPointer(offset);
 
-        longRedCls[j++] = offset;
+        //Stats Update
+        tmpStats.removed.incorporate(cl);
+        tmpStats.removed.age += sumConfl - cl->stats.conflictNumIntroduced;
+
+        //free clause
+        evictRedClause(offset, tmpStats);
     }
 
-    //Resize learnt datastruct
-    longRedCls.resize(longRedCls.size() - (i - j));
+    //Keep the rest
+    for (; i < cleanKeys.size(); i++) {
+        const ClOffset offset = cleanKeys[i].offset;
+        tmpStats.local.incorporate(clAllocator->getPointer(offset));
+        longRedCls.push_back(offset);
+    }
+
+    //Count what is left
+    for (i = 0; i < longRedCls.size(); i++) {
+        const Clause* cl = clAllocator->getPointer(longRedCls[i]);
+        tmpStats.remain.incorporate(cl);
+        tmpStats.remain.age += sumConfl - cl->stats.conflictNumIntroduced;
+    }
 
     //Reattach what's left
     detachReattach.reattachLongs();
@@ -1416,6 +1504,32 @@ CleaningStats Solver::reduceDB()
     return tmpStats;
 }
 
+/**
+@brief Frees a learnt clause removed by reduceDB(), spilling it if it's in tier2
+
+The clause must be detached
+*/
+void Solver::evictRedClause(const ClOffset offset, CleaningStats& tmpStats)
+{
+    Clause* cl = clAllocator->getPointer(offset);
+    if (conf.doSpillLearnts
+        && cl->stats.glue <= conf.glueTier2Max
+        && clauseSpill->spill(*cl)
+    ) {
+        tmpStats.spilled.incorporate(cl);
+    }
+
+    #ifdef DRUP
+    if (drup) {
+        (*drup)
+        << "d "
+        << *cl
+        << " 0\n";
+    }
+    #endif
+    clAllocator->clauseFree(offset);
+}
+
 lbool Solver::solve(const vector<Lit>* _assumptions)
 {
     release_assert(!(conf.doLHBR && !conf.propBinFirst)
@@ -1437,11 +1551,19 @@ lbool Solver::solve(const vector<Lit>* _assumptions)
         sqlStats->setup(this);
     }
 
-    //Initialise stuff
+    //Initialise stuff. Repeated calls (e.g. with assumptions) must not push
+    //the next cleaning further away every time
     nextCleanLimitInc = conf.startClean;
-    nextCleanLimit += nextCleanLimitInc;
+    nextCleanLimit = std::max<uint64_t>(
+        nextCleanLimit
+        , sumStats.conflStats.numConflicts + nextCleanLimitInc
+    );
     if (_assumptions != NULL) {
         assumptions = *_assumptions;
+        outsideToOuter(assumptions);
+
+        //The variables may have been renumbered by an earlier call
+        updateLitsMap(assumptions, outerToInterMain);
     }
 
     //Check if adding the clauses caused UNSAT
@@ -1474,7 +1596,17 @@ lbool Solver::solve(const vector<Lit>* _assumptions)
             printClauseSizeDistrib();
 
         //This is crucial, since we need to attach() clauses to threads
-        clauseCleaner->removeAndCleanAll();
+        //Nothing to clean if there were no new assignments since the last
+        //time, which is the common case when called with assumptions
+        if (trail.size() != lastCleanZeroDepthAssigns) {
+            clauseCleaner->removeAndCleanAll();
+            lastCleanZeroDepthAssigns = trail.size();
+        }
+
+        //Propagate pairwise at-most-one constraints natively during search
+        if (conf.doFindCards) {
+            cardFinder->find();
+        }
 
         //Solve using threads
         const size_t origTrailSize = trail.size();
@@ -1491,6 +1623,11 @@ lbool Solver::solve(const vector<Lit>* _assumptions)
         //Solve and update stats
         status = Searcher::solve(assumptions, numConfls);
 
+        //Everything apart from search works on the binaries
+        if (!cardFinder->restoreBins()) {
+            status = l_False;
+        }
+
         //If stats indicate that recursive minimization is not helping
         //turn it off
         if (status == l_Undef
@@ -1592,6 +1729,10 @@ lbool Solver::solve(const vector<Lit>* _assumptions)
         if (status != l_False) {
             Searcher::resetStats();
             fullReduce();
+            if (!ok) {
+                status = l_False;
+                break;
+            }
         }
 
         zeroLevAssignsByThreads += trail.size() - origTrailSize;
@@ -1616,8 +1757,7 @@ lbool Solver::solve(const vector<Lit>* _assumptions)
         if (conf.doSimplify
             || conf.doFindAndReplaceEqLits
         ) {
-            SolutionExtender extender(this, solution);
-            extender.extend();
+            solutionExtender->extend(solution);
         } else {
             model = solution;
         }
@@ -1625,9 +1765,23 @@ lbool Solver::solve(const vector<Lit>* _assumptions)
 
         //Renumber model back to original variable numbering
         updateArrayRev(model, interToOuterMain);
+
+        //Project away the BVA variables
+        if (numBvaVars > 0) {
+            for(size_t i = 0; i < nVarsOutside(); i++) {
+                model[i] = model[outsideToOuterMain[i]];
+            }
+            model.resize(nVarsOutside());
+        }
     } else {
         //Back-number the conflict
         updateLitsMap(conflict, interToOuterMain);
+        if (numBvaVars > 0) {
+            for(Lit& lit: conflict) {
+                assert(outerToOutsideMain[lit.var()] != var_Undef);
+                lit = Lit(outerToOutsideMain[lit.var()], lit.sign());
+            }
+        }
     }
     checkDecisionVarCorrectness();
     checkImplicitStats();
@@ -1656,7 +1810,9 @@ to try to simplifcy the problem at hand.
 */
 lbool Solver::simplifyProblem()
 {
+    lbool status = l_Undef;
     assert(ok);
+    lastCleanZeroDepthAssigns = std::numeric_limits<size_t>::max();
     testAllClauseAttach();
     #ifdef DEBUG_IMPLICIT_STATS
     checkStats();
@@ -1681,8 +1837,6 @@ lbool Solver::simplifyProblem()
     if (conf.doCompHandler
         && getNumFreeVars() < conf.compVarLimit
         && solveStats.numSimplify >= conf.handlerFromSimpNum
-        //Only every 2nd, since it can be costly to find parts
-        && solveStats.numSimplify % 2 == 0
     ) {
         if (!compHandler->handle())
             goto end;
@@ -1747,6 +1901,14 @@ lbool Solver::simplifyProblem()
             goto end;
     }
 
+    //Equivalences of gates that SCC can't see
+    if (conf.doSweep
+        && conf.doFindAndReplaceEqLits
+        && !sweeper->sweep()
+    ) {
+        goto end;
+    }
+
     //Check if time is up
     if (needToInterrupt)
         return l_Undef;
@@ -1824,6 +1986,11 @@ lbool Solver::simplifyProblem()
 
     reArrangeClauses();
 
+    //Local search, may find a solution, otherwise sets the polarities
+    if (conf.doLocalSearch) {
+        status = localSearch->run();
+    }
+
     //addSymmBreakClauses();
 
 end:
@@ -1847,7 +2014,7 @@ end:
     } else {
         checkStats();
         checkImplicitPropagated();
-        return l_Undef;
+        return status;
     }
 }
 
@@ -2071,6 +2238,9 @@ void Solver::fullReduce()
     CleaningStats iterCleanStat = reduceDB();
     consolidateMem();
 
+    //May make the problem UNSAT, 'ok' is checked by the caller
+    clauseSpill->reload();
+
     if (conf.doSQL) {
         sqlStats->reduceDB(irredStats, redStats, iterCleanStat, solver);
     }
@@ -2330,6 +2500,46 @@ void Solver::printFullStats() const
         implCache.printStats(this);
     }
 
+    //Portfolio stats
+    if (shared) {
+        printStatsLine("c portfolio imported units"
+            , numImportedUnits
+        );
+        printStatsLine("c portfolio imported bins"
+            , numImportedBins
+        );
+    }
+
+    //Task pool stats
+    if (taskPool->getStats().numRuns > 0) {
+        taskPool->getStats().print(taskPool->getNumThreads());
+    }
+
+    //Solution extension stats
+    if (solutionExtender->getStats().numCalls > 0) {
+        solutionExtender->getStats().print();
+    }
+
+    //Spilled learnt clause stats
+    if (clauseSpill->getStats().numSpilled > 0) {
+        clauseSpill->getStats().print();
+    }
+
+    //Local search stats
+    if (localSearch->getStats().numCalls > 0) {
+        localSearch->getStats().print();
+    }
+
+    //At-most-one constraint stats
+    if (cardFinder->getStats().numCalls > 0) {
+        cardFinder->getStats().print();
+    }
+
+    //SAT sweeping stats
+    if (sweeper->getStats().numCalls > 0) {
+        sweeper->getStats().print();
+    }
+
     //Other stats
     printStatsLine("c Conflicts in UIP"
         , sumStats.conflStats.numConflicts
@@ -2377,6 +2587,12 @@ void Solver::printMemStats() const
         , "%"
     );
     account += mem;
+    printStatsLine("c Mem peak for longclauses"
+        , clAllocator->getPeakMemUsed()/(1024UL*1024UL)
+        , "MB"
+        , clAllocator->getNumSlabs()
+        , "slabs now"
+    );
 
     account += printWatchMemUsed(totalMem);
 
@@ -2465,6 +2681,8 @@ void Solver::printMemStats() const
     mem += interToOuter2.capacity()*sizeof(Var);
     mem += outerToInter.capacity()*sizeof(Var);
     mem += outerToInterMain.capacity()*sizeof(Var);
+    mem += outsideToOuterMain.capacity()*sizeof(Var);
+    mem += outerToOutsideMain.capacity()*sizeof(Var);
     printStatsLine("c Mem for renumberer"
         , mem/(1024UL*1024UL)
         , "MB"
@@ -2502,6 +2720,60 @@ void Solver::printMemStats() const
     );
     account += mem;
 
+    mem = taskPool->memUsed();
+    printStatsLine("c Mem for task pool"
+        , mem/(1024UL*1024UL)
+        , "MB"
+        , (double)mem/(double)totalMem*100.0
+        , "%"
+    );
+    account += mem;
+
+    mem = solutionExtender->memUsed();
+    printStatsLine("c Mem for sol. extender"
+        , mem/(1024UL*1024UL)
+        , "MB"
+        , (double)mem/(double)totalMem*100.0
+        , "%"
+    );
+    account += mem;
+
+    mem = clauseSpill->memUsed();
+    printStatsLine("c Mem for clause spill"
+        , mem/(1024UL*1024UL)
+        , "MB"
+        , (double)mem/(double)totalMem*100.0
+        , "%"
+    );
+    account += mem;
+
+    mem = localSearch->memUsed();
+    printStatsLine("c Mem for local search"
+        , mem/(1024UL*1024UL)
+        , "MB"
+        , (double)mem/(double)totalMem*100.0
+        , "%"
+    );
+    account += mem;
+
+    mem = cardFinder->memUsed();
+    printStatsLine("c Mem for at-most-one"
+        , mem/(1024UL*1024UL)
+        , "MB"
+        , (double)mem/(double)totalMem*100.0
+        , "%"
+    );
+    account += mem;
+
+    mem = sweeper->memUsed();
+    printStatsLine("c Mem for sweeping"
+        , mem/(1024UL*1024UL)
+        , "MB"
+        , (double)mem/(double)totalMem*100.0
+        , "%"
+    );
+    account += mem;
+
     mem = sCCFinder->memUsed();
     printStatsLine("c Mem for SCC"
         , mem/(1024UL*1024UL)
@@ -2978,25 +3250,44 @@ bool Solver::verifyClauses(const vector<ClOffset>& cs) const
     cout << "Checking clauses whether they have been properly satisfied." << endl;;
     #endif
 
-    bool verificationOK = true;
+    //Check in chunks, in parallel
+    const size_t chunkSize = 20000;
+    const size_t numChunks = (cs.size() + chunkSize - 1)/chunkSize;
+    vector<size_t> numUnsat(numChunks, 0);
+    taskPool->run(numChunks, [&](const size_t chunk, TaskScratch&) {
+        const size_t end = std::min(cs.size(), (chunk+1)*chunkSize);
+        for(size_t i = chunk*chunkSize; i < end; i++) {
+            if (!modelSatisfies(*clAllocator->getPointer(cs[i])))
+                numUnsat[chunk]++;
+        }
+    });
+
+    if (TaskPool::reduce(numUnsat, (size_t)0, std::plus<size_t>()) == 0)
+        return true;
 
+    //Print the unsatisfied ones in order
     for (vector<ClOffset>::const_iterator
         it = cs.begin(), end = cs.end()
         ; it != end
         ; it++
     ) {
-        Clause& cl = *clAllocator->getPointer(*it);
-        for (uint32_t j = 0; j < cl.size(); j++)
-            if (modelValue(cl[j]) == l_True)
-                goto next;
+        const Clause& cl = *clAllocator->getPointer(*it);
+        if (!modelSatisfies(cl)) {
+            cout << "unsatisfied clause: " << cl << endl;
+        }
+    }
+
+    return false;
+}
 
-        cout << "unsatisfied clause: " << cl << endl;
-        verificationOK = false;
-        next:
-        ;
+bool Solver::modelSatisfies(const Clause& cl) const
+{
+    for (uint32_t j = 0; j < cl.size(); j++) {
+        if (modelValue(cl[j]) == l_True)
+            return true;
     }
 
-    return verificationOK;
+    return false;
 }
 
 bool Solver::verifyModel() const
@@ -3062,6 +3353,132 @@ lbool Solver::modelValue (const Lit p) const
     return model[p.var()] ^ p.sign();
 }
 
+/**
+@brief Only the given (outer) variables need a value in the model
+
+Eliminated variables that the given ones don't depend on will be l_Undef in
+the model. Empty vector means all variables are needed.
+*/
+void Solver::setModelProjection(const vector<Var>& vars)
+{
+    vector<Var> outer(vars);
+    for(Var& var: outer) {
+        if (var < nVarsOutside()) {
+            var = outsideToOuterMain[var];
+        }
+    }
+    solutionExtender->setProjection(outer);
+}
+
+void Solver::setSharedData(SharedData* _shared, const size_t _threadNum)
+{
+    shared = _shared;
+    threadNum = _threadNum;
+    nextSyncConfl = sumConflicts() + conf.syncEveryConfl;
+}
+
+/**
+@brief Maps internal literal to outside numbering, lit_Undef if it's a BVA var
+*/
+Lit Solver::interToOutside(const Lit lit) const
+{
+    const Lit outer = getUpdatedLit(lit, interToOuterMain);
+    const Var outside = outerToOutsideMain[outer.var()];
+    if (outside == var_Undef)
+        return lit_Undef;
+
+    return Lit(outside, outer.sign());
+}
+
+void Solver::exportUnit(const Lit lit)
+{
+    const Lit outside = interToOutside(lit);
+    if (outside == lit_Undef)
+        return;
+
+    shared->exportUnit(threadNum, outside);
+}
+
+void Solver::exportBin(const Lit lit1, const Lit lit2)
+{
+    const Lit outside1 = interToOutside(lit1);
+    const Lit outside2 = interToOutside(lit2);
+    if (outside1 == lit_Undef || outside2 == lit_Undef)
+        return;
+
+    shared->exportBin(threadNum, outside1, outside2);
+}
+
+/**
+@brief Maps outer literal to internal, and to its replacement if replaced
+
+Returns FALSE if the variable has been removed (e.g. eliminated), in which
+case the clause must not be imported
+*/
+bool Solver::outerToImportable(Lit& lit) const
+{
+    lit = getUpdatedLit(lit, outerToInterMain);
+    lit = varReplacer->getLitReplacedWith(lit);
+
+    return varData[lit.var()].removed == Removed::none;
+}
+
+/**
+@brief Exchanges learnt units and binaries with the other portfolio solvers
+
+Must be called at decision level 0. Imported clauses are added as learnt.
+They are implied by the original problem, so adding them is sound even if
+some variables have been eliminated here.
+
+@returns FALSE if the problem became UNSAT. If the portfolio must stop, the
+solver is interrupted
+*/
+bool Solver::syncShared()
+{
+    assert(decisionLevel() == 0);
+    while(sumConflicts() >= nextSyncConfl) {
+        nextSyncConfl += conf.syncEveryConfl;
+        if (!shared->sync(threadNum, importUnits, importBins)) {
+            setNeedToInterrupt();
+            break;
+        }
+    }
+
+    vector<Lit> lits;
+    for(size_t i = 0; i < importUnits.size() && ok; i++) {
+        Lit lit = importUnits[i];
+        lit = Lit(outsideToOuterMain[lit.var()], lit.sign());
+        if (!outerToImportable(lit))
+            continue;
+
+        if (value(lit) == l_Undef)
+            numImportedUnits++;
+
+        lits.clear();
+        lits.push_back(lit);
+        addClauseInt(lits, true);
+    }
+
+    for(size_t i = 0; i+1 < importBins.size() && ok; i += 2) {
+        Lit lit1 = importBins[i];
+        Lit lit2 = importBins[i+1];
+        lit1 = Lit(outsideToOuterMain[lit1.var()], lit1.sign());
+        lit2 = Lit(outsideToOuterMain[lit2.var()], lit2.sign());
+        if (!outerToImportable(lit1) || !outerToImportable(lit2))
+            continue;
+
+        numImportedBins++;
+        lits.clear();
+        lits.push_back(lit1);
+        lits.push_back(lit2);
+        addClauseInt(lits, true);
+    }
+    importUnits.clear();
+    importBins.clear();
+
+    return ok;
+}
+
 void Solver::testAllClauseAttach() const
 {
 #ifndef DEBUG_ATTACH_MORE
@@ -3075,6 +3492,10 @@ void Solver::testAllClauseAttach() const
     ) {
         assert(normClauseIsAttached(*it));
     }
+
+    for (size_t i = 0; i < watches.size(); i++) {
+        assert(binsAtFront(watches[i]));
+    }
 }
 
 bool Solver::normClauseIsAttached(const ClOffset offset) const
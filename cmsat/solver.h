@@ -51,6 +51,12 @@ class SQLStats;
 class ImplCache;
 class CompFinder;
 class CompHandler;
+class TaskPool;
+class ClauseSpill;
+class LocalSearch;
+class CardFinder;
+class Sweeper;
+class SharedData;
 
 class LitReachData {
     public:
@@ -79,10 +85,13 @@ class Solver : public Searcher
         void        setNeedToInterrupt();
         vector<lbool>  model;
         lbool   modelValue (const Lit p) const;  ///<Found model value for lit
+        void    setModelProjection(const vector<Var>& vars); ///<Only extend model to these (outer) vars
+        void    setSharedData(SharedData* shared, const size_t threadNum); ///<Portfolio solving
 
         //////////////////////////////
         // Problem specification:
         Var  newVar(const bool dvar = true); ///< Add new variable
+        uint32_t nVarsOutside() const; ///<Number of variables the user sees
         bool addClause(const vector<Lit>& ps);  ///< Add clause to the solver
         bool addXorClause(const vector<Var>& vars, bool rhs);
         bool addLearntClause(
@@ -361,6 +370,11 @@ class Solver : public Searcher
         friend class ClauseAllocator;
         friend class StateSaver;
         friend class SolutionExtender;
+        friend class ClauseSpill;
+        friend class LocalSearch;
+        friend class CardFinder;
+        friend class Sweeper;
+        friend class Backbone;
         friend class VarReplacer;
         friend class SCCFinder;
         friend class Prober;
@@ -383,6 +397,12 @@ class Solver : public Searcher
         ClauseCleaner       *clauseCleaner;
         VarReplacer         *varReplacer;
         CompHandler         *compHandler;
+        SolutionExtender    *solutionExtender;
+        TaskPool            *taskPool;
+        ClauseSpill         *clauseSpill;
+        LocalSearch         *localSearch;
+        CardFinder          *cardFinder;
+        Sweeper             *sweeper;
         MTRand              mtrand;           ///< random number generator
 
         /////////////////////////////
@@ -393,10 +413,21 @@ class Solver : public Searcher
         //Renumberer
         vector<Var> outerToInterMain;
         vector<Var> interToOuterMain;
+
+        //Outside numbering is what the user sees: the outer numbering without
+        //the variables added by BVA. These are var_Undef in outerToOutsideMain
+        vector<Var> outsideToOuterMain;
+        vector<Var> outerToOutsideMain;
+        size_t numBvaVars;
+        Var  newVarInt(const bool dvar);
+        Var  newBvaVar();
+        void outsideToOuter(vector<Lit>& ps) const;
+        bool addClauseOuter(const vector<Lit>& ps);
         vector<Var> outerToInter; //last renumber
         vector<Var> interToOuter; //last renumber
         vector<uint32_t> interToOuter2;
         void renumberVariables();
+        void calcLocalityOrder(const vector<char>& active, vector<Var>& order) const;
         void freeUnusedWatches();
         void saveVarMem(uint32_t newNumVars);
         void unSaveVarMem();
@@ -406,48 +437,34 @@ class Solver : public Searcher
         bool verifyModel() const;
         bool verifyImplicitClauses() const;
         bool verifyClauses(const vector<ClOffset>& cs) const;
+        bool modelSatisfies(const Clause& cl) const;
 
         ///////////////////////////
         // Clause cleaning
         void fullReduce();
         void clearClauseStats(vector<ClOffset>& clauseset);
         CleaningStats reduceDB();           ///<Reduce the set of learnt clauses.
-        struct reduceDBStructGlue
+        void evictRedClause(const ClOffset offset, CleaningStats& tmpStats);
+        struct CleanKey
         {
-            reduceDBStructGlue(ClauseAllocator* _clAllocator) :
-                clAllocator(_clAllocator)
+            CleanKey(const uint64_t _key, const ClOffset _offset) :
+                key(_key)
+                , offset(_offset)
             {}
-            ClauseAllocator* clAllocator;
 
-            bool operator () (const ClOffset x, const ClOffset y);
-        };
-        struct reduceDBStructSize
-        {
-            reduceDBStructSize(ClauseAllocator* _clAllocator) :
-                clAllocator(_clAllocator)
-            {}
-            ClauseAllocator* clAllocator;
+            uint64_t key; ///<Lower is worse
+            ClOffset offset;
 
-            bool operator () (const ClOffset x, const ClOffset y);
-        };
-        struct reduceDBStructActivity
-        {
-            reduceDBStructActivity(ClauseAllocator* _clAllocator) :
-                clAllocator(_clAllocator)
-            {}
-            ClauseAllocator* clAllocator;
-
-            bool operator () (const ClOffset x, const ClOffset y);
-        };
-        struct reduceDBStructPropConfl
-        {
-            reduceDBStructPropConfl(ClauseAllocator* _clAllocator) :
-                clAllocator(_clAllocator)
-            {}
-            ClauseAllocator* clAllocator;
+            bool operator<(const CleanKey& other) const
+            {
+                if (key != other.key)
+                    return key < other.key;
 
-            bool operator () (const ClOffset x, const ClOffset y);
+                return offset < other.offset;
+            }
         };
+        uint64_t cleaningKey(const Clause* cl) const;
+        vector<CleanKey> cleanKeys;
 
         /////////////////////
         // Data
@@ -460,6 +477,22 @@ class Solver : public Searcher
         void unsetDecisionVar(const uint32_t var);
         size_t               zeroLevAssignsByCNF;
         size_t               zeroLevAssignsByThreads;
+        size_t               lastCleanZeroDepthAssigns; ///<Trail size at the last cleaning in solve()
+
+        /////////////////////
+        // Portfolio
+        SharedData*          shared;
+        size_t               threadNum;
+        uint64_t             nextSyncConfl;
+        vector<Lit>          importUnits;
+        vector<Lit>          importBins;
+        uint64_t             numImportedUnits;
+        uint64_t             numImportedBins;
+        bool syncShared();
+        void exportUnit(const Lit lit);
+        void exportBin(const Lit lit1, const Lit lit2);
+        bool outerToImportable(Lit& lit) const;
+        Lit  interToOutside(const Lit lit) const;
         vector<LitReachData> litReachable;
         void calcReachability();
 
@@ -598,6 +631,11 @@ inline size_t Solver::getNumLongRedCls() const
     return longRedCls.size();
 }
 
+inline uint32_t Solver::nVarsOutside() const
+{
+    return outsideToOuterMain.size();
+}
+
 inline const vector<Var>& Solver::getInterToOuterMain() const
 {
     return interToOuterMain;
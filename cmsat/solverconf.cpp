@@ -45,6 +45,13 @@ SolverConf::SolverConf() :
         , maxNumLearntsRatio(10)
         , clauseDecayActivity(1.0/0.999)
 
+        //Learnt clause tiers
+        , glueCoreMax(2)
+        , glueTier2Max(6)
+        , doSpillLearnts(true)
+        , spillMaxMB(256)
+        , spillActiveRatio(0.1)
+
         //Restarting
         , restart_first(300)
         , restart_inc(2)
@@ -52,6 +59,17 @@ SolverConf::SolverConf() :
         , restartType(Restart::automatic)
         , optimiseUnsat(0)
 
+        //Focused/stable mode switching
+        , emaGlueFast(0.03)
+        , emaGlueSlow(1e-5)
+        , emaRestartMargin(1.1)
+        , lubyUnit(512)
+        , modeSwitchFirst(1000)
+        , modeSwitchInc(2.0)
+        , var_inc_multiplier_stable(20)
+        , var_inc_divider_stable(19)
+        , rephaseInterval(1000)
+
         //Clause minimisation
         , doRecursiveMinim (true)
         , doMinimLearntMore(true)
@@ -103,6 +121,12 @@ SolverConf::SolverConf() :
         , varelimStrategy  (0)
         , varElimCostEstimateStrategy(0)
         , varElimRatioPerIter(0.12)
+        , doGateElim       (true)
+
+        //Bounded variable addition
+        , doBva            (true)
+        , bvaLimitM        (20)
+        , bvaMinGain       (2)
 
         //Probing
         , doProbe          (true)
@@ -114,6 +138,23 @@ SolverConf::SolverConf() :
         , cacheUpdateCutoff(2000)
         , maxCacheSizeMB   (2048)
 
+        //Local search
+        , doLocalSearch    (true)
+        , localSearchMBogo (5)
+
+        //At-most-one constraints
+        , doFindCards      (true)
+        , cardMinSize      (6)
+        , doCardRemBins    (true)
+        , cardFindLimitM   (20)
+
+        //SAT sweeping
+        , doSweep          (true)
+        , sweepSimWords    (4)
+        , sweepConflPerCall(100)
+        , sweepLimitM      (10)
+        , sweepFindLimitM  (20)
+
         //XOR
         , doFindXors       (true)
         , maxXorToFind     (5)
@@ -146,6 +187,7 @@ SolverConf::SolverConf() :
 
         //optimisations to do
         , doRenumberVars   (true)
+        , doRenumberLocality (true)
         , doSaveMem        (true)
 
         //Component finding
@@ -153,10 +195,11 @@ SolverConf::SolverConf() :
         , doCompHandler    (true)
         , handlerFromSimpNum (0)
         , compVarLimit      (1ULL*1000ULL*1000ULL)
-        , compFindLimitMega (500)
 
         , doExtBinSubs     (true)
         , doClausVivif     (true)
+        , doVivifLearnt    (true)
+        , vivifLearntPropsPerConfl(500)
         , doSortWatched    (true)
         , doStrSubImplicit (true)
 
@@ -171,6 +214,10 @@ SolverConf::SolverConf() :
         , doFindEqLitsWithGates(true)
         , doMixXorAndGates (false)
 
+        , numThreads(1)
+        , doDeterministic(true)
+        , syncEveryConfl(2000)
+
         , needToDumpLearnts(false)
         , needToDumpSimplified (false)
         , needResultFile       (false)
@@ -67,6 +67,13 @@ class SolverConf
         double    maxNumLearntsRatio; ///<Number of red clauses must not be more than red*maxNumLearntsRatio
         double    clauseDecayActivity;
 
+        //Learnt clause tiers
+        uint32_t  glueCoreMax; ///<Learnt clauses with at most this glue are never removed
+        uint32_t  glueTier2Max; ///<Learnt clauses with at most this glue are only removed if unused since the last cleaning
+        int       doSpillLearnts; ///<Write evicted tier2 clauses to a spill file instead of freeing them
+        uint64_t  spillMaxMB; ///<Maximum size of the spill file
+        double    spillActiveRatio; ///<Ratio of most active vars that are considered active when reloading from the spill file
+
         //For restarting
         uint64_t    restart_first;      ///<The initial restart limit.                                                                (default 100)
         double    restart_inc;        ///<The factor with which the restart limit is multiplied in each restart.                    (default 1.5)
@@ -74,6 +81,17 @@ class SolverConf
         Restart  restartType;   ///<If set, the solver will always choose the given restart strategy
         int       optimiseUnsat;
 
+        //Focused/stable mode switching
+        double    emaGlueFast; ///<Alpha of the fast glue EMA of EMA restarts
+        double    emaGlueSlow; ///<Alpha of the slow glue EMA of EMA restarts
+        double    emaRestartMargin; ///<Restart if the fast glue EMA is this much above the slow one
+        uint64_t  lubyUnit; ///<Luby restarts are this many conflicts times the Luby sequence
+        uint64_t  modeSwitchFirst; ///<Conflicts of the first focused phase
+        double    modeSwitchInc; ///<Propagation budget of the phases is multiplied by this after every stable phase
+        uint32_t  var_inc_multiplier_stable;
+        uint32_t  var_inc_divider_stable;
+        uint64_t  rephaseInterval; ///<Rephase in stable mode every N*this conflicts, N=number of rephases so far
+
         //Clause minimisation
         int doRecursiveMinim;
         int doMinimLearntMore;  ///<Perform learnt-clause minimisation using watchists' binary and tertiary clauses? ("strong minimization" in PrecoSat)
@@ -125,6 +143,12 @@ class SolverConf
         int      varelimStrategy; ///<Guess varelim order, or calculate?
         int      varElimCostEstimateStrategy;
         double    varElimRatioPerIter;
+        int      doGateElim; ///<Only add gate-vs-non-gate resolvents of vars defined by a gate
+
+        //Bounded variable addition
+        int      doBva;
+        uint64_t bvaLimitM; ///<Bogo-props budget per call, in millions
+        int      bvaMinGain; ///<Only re-encode if at least this many clauses are saved
 
         //Probing
         int      doProbe;
@@ -136,6 +160,23 @@ class SolverConf
         uint64_t   cacheUpdateCutoff;
         uint64_t   maxCacheSizeMB;
 
+        //Local search
+        int      doLocalSearch; ///<Run ProbSAT on the irredundant clauses at the end of every simplification
+        uint64_t localSearchMBogo; ///<Budget of one local search run, in millions of bogoprops
+
+        //At-most-one constraints
+        int      doFindCards; ///<Propagate pairwise at-most-one constraints natively during search
+        uint32_t cardMinSize; ///<Smallest at-most-one constraint to treat natively
+        int      doCardRemBins; ///<Remove the binaries of the native constraints
+        uint64_t cardFindLimitM; ///<Budget of finding, in millions of bogoprops
+
+        //SAT sweeping
+        int      doSweep; ///<Find equivalent literals of gates through simulation and SAT calls
+        uint32_t sweepSimWords; ///<Simulate this many times 64 random patterns
+        uint64_t sweepConflPerCall; ///<Conflict budget of one SAT call proving a candidate
+        uint64_t sweepLimitM; ///<Budget of all SAT calls, in millions of bogoprops
+        uint64_t sweepFindLimitM; ///<Budget of gate extraction, in millions of bogoprops
+
         //XORs
         int      doFindXors;
         int      maxXorToFind;
@@ -170,6 +211,7 @@ class SolverConf
         //Optimisations to do
         bool      printAllRestarts;
         int       doRenumberVars;
+        int       doRenumberLocality; ///<Place the vars that share clauses next to each other
         int       doSaveMem;
 
         //Component handling
@@ -177,12 +219,13 @@ class SolverConf
         int       doCompHandler;
         uint64_t    handlerFromSimpNum;
         uint64_t    compVarLimit;
-        uint64_t  compFindLimitMega;
 
 
         int      doExtBinSubs;
 
         int      doClausVivif;      ///<Perform asymmetric branching at the beginning of the solving
+        int      doVivifLearnt; ///<Vivify tier1/tier2 learnt clauses during search, after cleaning the learnt clauses
+        uint64_t vivifLearntPropsPerConfl; ///<Budget of learnt clause vivification, in bogoprops per conflict since the last one
         int      doSortWatched;      ///<Sort watchlists according to size&type: binary, tertiary, normal (>3-long), xor clauses
         int      doStrSubImplicit;
 
@@ -199,6 +242,11 @@ class SolverConf
         int      doFindEqLitsWithGates; ///<Find equivalent literals using gates during subsumption
         int      doMixXorAndGates; ///<Try to gain knowledge by mixing XORs and gates
 
+        //Threading
+        int       numThreads; ///<Number of workers of the task pool, including the main thread
+        int       doDeterministic; ///<Portfolio solvers exchange clauses at fixed conflict counts, with a barrier
+        uint64_t  syncEveryConfl; ///<Portfolio solvers exchange clauses every this many conflicts
+
         //interrupting & dumping
         bool      needToDumpLearnts;  ///<If set to TRUE, learnt clauses will be dumped to the file speified by "learntsFilename"
         bool      needToDumpSimplified;     ///<If set to TRUE, a simplified version of the original clause-set will be dumped to the file speified by "origFilename". The solution to this file should perfectly satisfy the problem
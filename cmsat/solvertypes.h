@@ -49,6 +49,9 @@ enum class Restart {
     , geom
     , agility
     , never
+    , glue_ema
+    , luby
+    , modeswitch
     , automatic
 };
 
@@ -70,6 +73,15 @@ inline std::string restart_type_to_string(const Restart type)
         case Restart::never:
             return "never restart";
 
+        case Restart::glue_ema:
+            return "glue EMA-based";
+
+        case Restart::luby:
+            return "luby";
+
+        case Restart::modeswitch:
+            return "focused/stable switching";
+
         case Restart::automatic:
             return "automatic";
     }
@@ -117,6 +129,27 @@ enum class PolarityMode {
     , automatic
 };
 
+//Focused mode restarts often and bumps aggressively, stable mode restarts
+//rarely and follows the target polarities
+enum class SearchMode {
+    focus
+    , stable
+};
+
+inline std::string search_mode_to_string(const SearchMode mode)
+{
+    switch(mode) {
+        case SearchMode::focus:
+            return "focus";
+
+        case SearchMode::stable:
+            return "stable";
+    }
+
+    assert(false && "oops, one of the search modes has no string name");
+    return "Oops, undefined!";
+}
+
 /**
 @brief A Literal, i.e. a variable with a sign
 */
@@ -0,0 +1,736 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "sweeper.h"
+#include "solver.h"
+#include "varreplacer.h"
+#include "time_mem.h"
+#include <algorithm>
+#include <limits>
+
+using namespace CMSat;
+
+static const uint32_t noGate = std::numeric_limits<uint32_t>::max();
+
+//Only record this many counterexamples per call
+static const size_t maxCex = 1024;
+
+Sweeper::Sweeper(Solver* _solver) :
+    solver(_solver)
+    , numMaxFind(0)
+    , simWords(0)
+    , prover(NULL)
+    , numCex(0)
+    , numMaxProve(0)
+{
+}
+
+bool Sweeper::sweep()
+{
+    assert(solver->ok);
+    assert(solver->decisionLevel() == 0);
+
+    #ifdef DRUP
+    //The equivalences are not RUP
+    if (solver->drup)
+        return solver->ok;
+    #endif
+
+    runStats.numCalls = 1;
+    double myTime = cpuTime();
+    findGates();
+    orderGates();
+    runStats.numGates = order.size();
+    runStats.findTime = cpuTime() - myTime;
+
+    cands.clear();
+    if (!order.empty()) {
+        myTime = cpuTime();
+        simulate();
+        buildClasses();
+        runStats.numCands = cands.size();
+        runStats.simTime = cpuTime() - myTime;
+    }
+
+    provedConst.clear();
+    provedEq.clear();
+    if (!cands.empty()) {
+        myTime = cpuTime();
+        setupProver();
+        proveCands();
+        if (numMaxProve <= 0)
+            runStats.proveTimeOut++;
+
+        delete prover;
+        prover = NULL;
+        runStats.proveTime = cpuTime() - myTime;
+    }
+    applyResults();
+
+    if (solver->conf.verbosity >= 2
+        || (solver->conf.verbosity >= 1 && runStats.numGates > 0)
+    ) {
+        runStats.printShort();
+    }
+    globalStats += runStats;
+    runStats.clear();
+
+    return solver->ok;
+}
+
+/**
+@brief Extracts the OR gates out = OR(l_1, ..., l_n)
+
+These are encoded as the clause (~out V l_1 V ... V l_n) together with the
+binaries (out V ~l_i). AND gates are OR gates with the output and the inputs
+negated, so they are found as well.
+*/
+void Sweeper::findGates()
+{
+    gates.clear();
+    gateLits.clear();
+    gateOf.clear();
+    gateOf.resize(solver->nVars(), noGate);
+    numMaxFind = solver->conf.sweepFindLimitM*1000LL*1000LL;
+
+    //Tri-clauses are only in the watchlists
+    Lit lits[3];
+    for(size_t i = 0; i < solver->nVars()*2 && numMaxFind > 0; i++) {
+        const Lit lit = Lit::toLit(i);
+        const vec<Watched>& ws = solver->watches[i];
+        numMaxFind -= ws.size();
+        for(vec<Watched>::const_iterator
+            it = ws.begin(), end = ws.end()
+            ; it != end
+            ; it++
+        ) {
+            if (!it->isTri()
+                || it->learnt()
+                || lit > it->lit2()
+            ) {
+                continue;
+            }
+
+            lits[0] = lit;
+            lits[1] = it->lit2();
+            lits[2] = it->lit3();
+            findGatesInClause(lits, 3);
+        }
+    }
+
+    for(vector<ClOffset>::const_iterator
+        it = solver->longIrredCls.begin(), end = solver->longIrredCls.end()
+        ; it != end && numMaxFind > 0
+        ; it++
+    ) {
+        const Clause& cl = *solver->clAllocator->getPointer(*it);
+        if (cl.size() > solver->conf.maxGateSize + 1)
+            continue;
+
+        findGatesInClause(cl.begin(), cl.size());
+    }
+}
+
+void Sweeper::findGatesInClause(const Lit* lits, const uint32_t size)
+{
+    vector<uint16_t>& seen = solver->seen;
+    for(uint32_t i = 0; i < size; i++) {
+        if (solver->value(lits[i]) != l_Undef)
+            return;
+    }
+
+    for(uint32_t i = 0; i < size; i++) {
+        const Lit out = ~lits[i];
+        if (gateOf[out.var()] != noGate)
+            continue;
+
+        //Mark the literals 'out' is in a binary with
+        const vec<Watched>& ws = solver->watches[out.toInt()];
+        size_t num = 0;
+        for(vec<Watched>::const_iterator
+            it = ws.begin(), end = ws.end()
+            ; it != end && it->isBinary()
+            ; it++
+        ) {
+            if (!it->learnt() && !seen[it->lit2().toInt()]) {
+                seen[it->lit2().toInt()] = 1;
+                num++;
+            }
+        }
+        numMaxFind -= ws.size() + size;
+
+        bool isGate = num + 1 >= size;
+        for(uint32_t i2 = 0; i2 < size && isGate; i2++) {
+            if (i2 != i && !seen[(~lits[i2]).toInt()])
+                isGate = false;
+        }
+
+        for(vec<Watched>::const_iterator
+            it = ws.begin(), end = ws.end()
+            ; it != end && it->isBinary()
+            ; it++
+        ) {
+            seen[it->lit2().toInt()] = 0;
+        }
+
+        if (!isGate)
+            continue;
+
+        gateOf[out.var()] = gates.size();
+        gates.push_back(Gate(out, gateLits.size(), size - 1));
+        for(uint32_t i2 = 0; i2 < size; i2++) {
+            if (i2 != i)
+                gateLits.push_back(lits[i2]);
+        }
+    }
+}
+
+/**
+@brief Orders the gate-defined vars so that inputs come before outputs
+
+Gates that are part of a cycle are dropped, their output is treated as input.
+*/
+void Sweeper::orderGates()
+{
+    order.clear();
+    topoPos.clear();
+    topoPos.resize(solver->nVars(), 0);
+
+    //0 = not visited, 1 = on the stack, 2 = done
+    vector<char> state(solver->nVars(), 0);
+    vector<std::pair<Var, uint32_t> > stack;
+    for(vector<Gate>::const_iterator
+        it = gates.begin(), end = gates.end()
+        ; it != end
+        ; it++
+    ) {
+        const Var root = it->out.var();
+        if (state[root] != 0)
+            continue;
+
+        state[root] = 1;
+        stack.push_back(std::make_pair(root, 0));
+        while(!stack.empty()) {
+            const Var var = stack.back().first;
+            const uint32_t at = gateOf[var];
+            if (at != noGate && stack.back().second < gates[at].size) {
+                const Lit input = gateLits[gates[at].start + stack.back().second];
+                stack.back().second++;
+                if (gateOf[input.var()] == noGate)
+                    continue;
+
+                if (state[input.var()] == 0) {
+                    state[input.var()] = 1;
+                    stack.push_back(std::make_pair(input.var(), 0));
+                } else if (state[input.var()] == 1) {
+                    gateOf[var] = noGate;
+                }
+                continue;
+            }
+
+            state[var] = 2;
+            if (gateOf[var] != noGate) {
+                order.push_back(var);
+                topoPos[var] = order.size();
+            }
+            stack.pop_back();
+        }
+    }
+}
+
+/**
+@brief Bit-parallel simulation of the gates, 64 random patterns per word
+
+The words of a var are contiguous, so the inner loops vectorise.
+*/
+void Sweeper::simulate()
+{
+    simWords = solver->conf.sweepSimWords;
+    sim.clear();
+    sim.resize(solver->nVars()*simWords, 0);
+
+    for(size_t var = 0; var < solver->nVars(); var++) {
+        uint64_t* words = &sim[var*simWords];
+        if (solver->value(var) != l_Undef) {
+            const uint64_t val = solver->value(var) == l_True ? ~0ULL : 0ULL;
+            std::fill(words, words + simWords, val);
+        } else if (gateOf[var] == noGate) {
+            for(size_t i = 0; i < simWords; i++) {
+                words[i] = ((uint64_t)solver->mtrand.randInt() << 32)
+                    | solver->mtrand.randInt();
+            }
+        }
+    }
+
+    for(vector<Var>::const_iterator
+        it = order.begin(), end = order.end()
+        ; it != end
+        ; it++
+    ) {
+        const Gate& gate = gates[gateOf[*it]];
+        uint64_t* out = &sim[*it*simWords];
+        std::fill(out, out + simWords, 0ULL);
+        for(uint32_t i = 0; i < gate.size; i++) {
+            const Lit input = gateLits[gate.start + i];
+            const uint64_t* in = &sim[input.var()*simWords];
+            const uint64_t inv = input.sign() ? ~0ULL : 0ULL;
+            for(size_t w = 0; w < simWords; w++) {
+                out[w] |= in[w] ^ inv;
+            }
+        }
+
+        if (gate.out.sign()) {
+            for(size_t w = 0; w < simWords; w++) {
+                out[w] = ~out[w];
+            }
+        }
+    }
+}
+
+//The signatures are normalised so that the first pattern is FALSE
+struct SigSorter
+{
+    SigSorter(
+        const vector<uint64_t>& _sim
+        , const size_t _simWords
+        , const vector<uint32_t>& _topoPos
+    ) :
+        sim(_sim)
+        , simWords(_simWords)
+        , topoPos(_topoPos)
+    {}
+
+    bool operator()(const Var a, const Var b) const
+    {
+        const uint64_t* wa = &sim[a*simWords];
+        const uint64_t* wb = &sim[b*simWords];
+        const uint64_t inva = (wa[0] & 1) ? ~0ULL : 0ULL;
+        const uint64_t invb = (wb[0] & 1) ? ~0ULL : 0ULL;
+        for(size_t i = 0; i < simWords; i++) {
+            if ((wa[i] ^ inva) != (wb[i] ^ invb))
+                return (wa[i] ^ inva) < (wb[i] ^ invb);
+        }
+
+        //Inputs and gates lower in the circuit first
+        if (topoPos[a] != topoPos[b])
+            return topoPos[a] < topoPos[b];
+
+        return a < b;
+    }
+
+    const vector<uint64_t>& sim;
+    const size_t simWords;
+    const vector<uint32_t>& topoPos;
+};
+
+bool Sweeper::sameSig(const Var a, const Var b) const
+{
+    const uint64_t* wa = &sim[a*simWords];
+    const uint64_t* wb = &sim[b*simWords];
+    const uint64_t inv = ((wa[0] ^ wb[0]) & 1) ? ~0ULL : 0ULL;
+    for(size_t i = 0; i < simWords; i++) {
+        if (wa[i] != (wb[i] ^ inv))
+            return false;
+    }
+
+    return true;
+}
+
+bool Sweeper::zeroSig(const Var var) const
+{
+    const uint64_t* words = &sim[var*simWords];
+    const uint64_t inv = (words[0] & 1) ? ~0ULL : 0ULL;
+    for(size_t i = 0; i < simWords; i++) {
+        if (words[i] != inv)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+@brief Groups the vars of the gates by simulation signature
+
+Only the vars that share their class with at least one other var, or that look
+constant, are kept.
+*/
+void Sweeper::buildClasses()
+{
+    vector<uint16_t>& seen = solver->seen;
+    for(vector<Var>::const_iterator
+        it = order.begin(), end = order.end()
+        ; it != end
+        ; it++
+    ) {
+        const Gate& gate = gates[gateOf[*it]];
+        seen[*it] = 1;
+        for(uint32_t i = 0; i < gate.size; i++) {
+            seen[gateLits[gate.start + i].var()] = 1;
+        }
+    }
+
+    vector<Var> all;
+    for(size_t var = 0; var < solver->nVars(); var++) {
+        if (!seen[var])
+            continue;
+
+        seen[var] = 0;
+        if (solver->value(var) == l_Undef
+            && solver->varData[var].removed == Removed::none
+        ) {
+            all.push_back(var);
+        }
+    }
+    std::sort(all.begin(), all.end(), SigSorter(sim, simWords, topoPos));
+
+    size_t start = 0;
+    while(start < all.size()) {
+        size_t end = start + 1;
+        while(end < all.size() && sameSig(all[start], all[end])) {
+            end++;
+        }
+
+        if (end - start > 1 || zeroSig(all[start])) {
+            cands.insert(cands.end(), all.begin() + start, all.begin() + end);
+        }
+        start = end;
+    }
+}
+
+void Sweeper::setupProver()
+{
+    SolverConf conf = solver->conf;
+    conf.verbosity = 0;
+    conf.doSchedSimpProblem = false;
+    conf.doPreSchedSimpProblem = false;
+    conf.doSimplify = false;
+    conf.doProbe = false;
+    conf.doCache = false;
+    conf.doStamp = false;
+    conf.doFindAndReplaceEqLits = false;
+    conf.doCompHandler = false;
+    conf.doFindComps = false;
+    conf.doRenumberVars = false;
+    conf.doLocalSearch = false;
+    conf.doFindCards = false;
+    conf.doSweep = false;
+    conf.doSpillLearnts = false;
+    conf.doSQL = false;
+    conf.numThreads = 1;
+    conf.burstSearchLen = 0;
+    conf.printFullStats = false;
+    conf.needToDumpLearnts = false;
+    conf.needToDumpSimplified = false;
+    conf.needResultFile = false;
+    conf.maxConfl = 0;
+    prover = new Solver(conf);
+    prover->mtrand.seed(solver->mtrand.randInt());
+    for(size_t i = 0; i < solver->nVars(); i++) {
+        prover->newVar();
+    }
+
+    //Irredundant clauses, in the same numbering
+    vector<Lit> lits;
+    for(size_t i = 0; i < solver->nVars()*2; i++) {
+        const Lit lit = Lit::toLit(i);
+        if (solver->value(lit) == l_True) {
+            lits.clear();
+            lits.push_back(lit);
+            prover->addClause(lits);
+        }
+
+        const vec<Watched>& ws = solver->watches[i];
+        for(vec<Watched>::const_iterator
+            it = ws.begin(), end = ws.end()
+            ; it != end
+            ; it++
+        ) {
+            if (it->isClause()
+                || it->learnt()
+                || lit > it->lit2()
+            ) {
+                continue;
+            }
+
+            lits.clear();
+            lits.push_back(lit);
+            lits.push_back(it->lit2());
+            if (it->isTri())
+                lits.push_back(it->lit3());
+            prover->addClause(lits);
+        }
+    }
+    for(vector<ClOffset>::const_iterator
+        it = solver->longIrredCls.begin(), end = solver->longIrredCls.end()
+        ; it != end
+        ; it++
+    ) {
+        const Clause& cl = *solver->clAllocator->getPointer(*it);
+        lits.assign(cl.begin(), cl.end());
+        prover->addClause(lits);
+    }
+
+    candIndex.clear();
+    candIndex.resize(solver->nVars(), 0);
+    for(size_t i = 0; i < cands.size(); i++) {
+        candIndex[cands[i]] = i;
+    }
+    cexWords.clear();
+    numCex = 0;
+    numMaxProve = solver->conf.sweepLimitM*1000LL*1000LL;
+}
+
+/**
+@brief Proves the candidates equivalent to the others of their class
+
+The candidates are visited lowest in the circuit first, so that the proved
+equivalences (added to the prover as binaries) make the proofs above easy.
+Every candidate is compared against the representatives of the sub-classes of
+its class found so far, unless a counterexample already tells them apart. The
+ones that are not equivalent to any of them start a new sub-class.
+*/
+void Sweeper::proveCands()
+{
+    //lit_Undef as sub-class representative stands for constant FALSE
+    classOf.resize(cands.size());
+    subReps.clear();
+    for(size_t i = 0; i < cands.size(); i++) {
+        if (i == 0 || !sameSig(cands[i-1], cands[i])) {
+            subReps.push_back(vector<Lit>());
+            if (zeroSig(cands[i]))
+                subReps.back().push_back(lit_Undef);
+        }
+        classOf[i] = subReps.size() - 1;
+    }
+
+    vector<std::pair<uint32_t, uint32_t> > byTopo;
+    for(size_t i = 0; i < cands.size(); i++) {
+        byTopo.push_back(std::make_pair(topoPos[cands[i]], i));
+    }
+    std::sort(byTopo.begin(), byTopo.end());
+
+    for(vector<std::pair<uint32_t, uint32_t> >::const_iterator
+        it = byTopo.begin(), end = byTopo.end()
+        ; it != end && numMaxProve > 0
+        ; it++
+    ) {
+        const Var var = cands[it->second];
+        const Lit lit = Lit(var, sim[var*simWords] & 1);
+        vector<Lit>& reps = subReps[classOf[it->second]];
+
+        bool done = false;
+        for(size_t i = 0; i < reps.size() && numMaxProve > 0; i++) {
+            const Lit rep = reps[i];
+            if (refutedByCex(rep, lit))
+                continue;
+
+            lbool ret = (rep == lit_Undef) ? proveFalse(lit) : proveEq(rep, lit);
+            if (ret == l_False)
+                continue;
+
+            if (ret == l_True) {
+                if (rep == lit_Undef) {
+                    provedConst.push_back(~lit);
+                } else {
+                    provedEq.push_back(std::make_pair(rep, lit));
+                }
+            }
+            done = true;
+            break;
+        }
+
+        if (!done)
+            reps.push_back(lit);
+    }
+}
+
+//Returns l_True if proved, l_False if refuted, l_Undef if over budget
+lbool Sweeper::proveEq(const Lit a, const Lit b)
+{
+    assumps.clear();
+    assumps.push_back(a);
+    assumps.push_back(~b);
+    lbool ret = solveProver();
+    if (ret != l_False)
+        return ret == l_True ? l_False : l_Undef;
+
+    assumps.clear();
+    assumps.push_back(~a);
+    assumps.push_back(b);
+    ret = solveProver();
+    if (ret != l_False)
+        return ret == l_True ? l_False : l_Undef;
+
+    //Help the later proofs
+    assumps.clear();
+    assumps.push_back(~a);
+    assumps.push_back(b);
+    prover->addClause(assumps);
+    assumps.clear();
+    assumps.push_back(a);
+    assumps.push_back(~b);
+    prover->addClause(assumps);
+    runStats.numProvedEq++;
+
+    return l_True;
+}
+
+lbool Sweeper::proveFalse(const Lit lit)
+{
+    assumps.clear();
+    assumps.push_back(lit);
+    lbool ret = solveProver();
+    if (ret != l_False)
+        return ret == l_True ? l_False : l_Undef;
+
+    assumps.clear();
+    assumps.push_back(~lit);
+    prover->addClause(assumps);
+    runStats.numProvedConst++;
+
+    return l_True;
+}
+
+lbool Sweeper::solveProver()
+{
+    runStats.numSatCalls++;
+    const uint64_t origProps = prover->sumPropStats.bogoProps;
+    prover->conf.maxConfl = prover->sumStats.conflStats.numConflicts
+        + solver->conf.sweepConflPerCall;
+    const lbool ret = prover->solve(&assumps);
+
+    //Setting up the search and copying the model is linear in the number of
+    //variables, which dominates the cost of the many easy calls
+    numMaxProve -= prover->sumPropStats.bogoProps - origProps + prover->nVars();
+
+    if (ret == l_True) {
+        runStats.numRefuted++;
+        addCex();
+    } else if (ret == l_Undef) {
+        runStats.numUnknown++;
+    }
+
+    return ret;
+}
+
+/**
+@brief Whether any of the counterexamples so far gives a and b different values
+
+lit_Undef as 'a' stands for constant FALSE
+*/
+bool Sweeper::refutedByCex(const Lit a, const Lit b) const
+{
+    const size_t numCands = cands.size();
+    for(size_t block = 0; block*64 < numCex; block++) {
+        const uint64_t mask = (numCex - block*64 >= 64)
+            ? ~0ULL : ((1ULL << (numCex - block*64)) - 1);
+
+        const uint64_t* words = &cexWords[block*numCands];
+        const uint64_t wb = words[candIndex[b.var()]] ^ (b.sign() ? ~0ULL : 0ULL);
+        const uint64_t wa = (a == lit_Undef) ? 0ULL
+            : words[candIndex[a.var()]] ^ (a.sign() ? ~0ULL : 0ULL);
+
+        if ((wa ^ wb) & mask)
+            return true;
+    }
+
+    return false;
+}
+
+void Sweeper::addCex()
+{
+    if (numCex >= maxCex)
+        return;
+
+    if (numCex % 64 == 0)
+        cexWords.resize(cexWords.size() + cands.size(), 0);
+
+    uint64_t* words = &cexWords[(numCex/64)*cands.size()];
+    const uint64_t bit = 1ULL << (numCex % 64);
+    for(size_t i = 0; i < cands.size(); i++) {
+        if (prover->model[cands[i]] == l_True)
+            words[i] |= bit;
+    }
+    numCex++;
+}
+
+bool Sweeper::applyResults()
+{
+    for(vector<Lit>::const_iterator
+        it = provedConst.begin(), end = provedConst.end()
+        ; it != end
+        ; it++
+    ) {
+        if (solver->value(*it) == l_Undef) {
+            solver->enqueue(*it);
+        } else if (solver->value(*it) == l_False) {
+            solver->ok = false;
+            return false;
+        }
+    }
+    solver->ok = solver->propagate().isNULL();
+    if (!solver->ok)
+        return false;
+
+    for(vector<std::pair<Lit, Lit> >::const_iterator
+        it = provedEq.begin(), end = provedEq.end()
+        ; it != end
+        ; it++
+    ) {
+        //Will be propagated by the replacing
+        if (solver->value(it->first) != l_Undef
+            || solver->value(it->second) != l_Undef
+        ) {
+            continue;
+        }
+
+        if (!solver->varReplacer->replace(
+            Lit(it->first.var(), false)
+            , Lit(it->second.var(), false)
+            , it->first.sign() == it->second.sign()
+            , false
+        )) {
+            return false;
+        }
+    }
+
+    if (!provedEq.empty())
+        return solver->varReplacer->performReplace();
+
+    return solver->ok;
+}
+
+uint64_t Sweeper::memUsed() const
+{
+    uint64_t mem = 0;
+    mem += gates.capacity()*sizeof(Gate);
+    mem += gateLits.capacity()*sizeof(Lit);
+    mem += gateOf.capacity()*sizeof(uint32_t);
+    mem += order.capacity()*sizeof(Var);
+    mem += sim.capacity()*sizeof(uint64_t);
+    mem += topoPos.capacity()*sizeof(uint32_t);
+    mem += cands.capacity()*sizeof(Var);
+    mem += candIndex.capacity()*sizeof(uint32_t);
+    mem += classOf.capacity()*sizeof(uint32_t);
+    mem += cexWords.capacity()*sizeof(uint64_t);
+
+    return mem;
+}
@@ -0,0 +1,256 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __SWEEPER_H__
+#define __SWEEPER_H__
+
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+class Solver;
+using std::vector;
+using std::cout;
+using std::endl;
+
+/**
+@brief Finds functionally equivalent literals through SAT sweeping
+
+SCC only finds equivalences that follow from binary implication cycles.
+Circuit-derived problems contain many signals that are equivalent but whose
+equivalence only follows through the gates, e.g. structurally different
+encodings of the same function in an equivalence checking miter.
+
+The OR gates (and so the AND gates) encoded in the irredundant clauses are
+extracted and ordered topologically. The gate inputs are given random values,
+64 patterns per word, and the gate outputs are simulated. Literals with the same
+simulation signature (modulo negation) are candidates for being equivalent,
+and literals with a constant signature are candidates for being constant.
+
+The candidates are proved with a sub-solver that holds the irredundant
+clauses, under assumptions and with a conflict budget per call. Satisfying
+assignments are counterexamples that split the candidate classes further.
+Proved equivalences are handed to VarReplacer, proved constants are enqueued.
+*/
+class Sweeper
+{
+    public:
+        Sweeper(Solver* solver);
+
+        //Must be called at decision level 0. Returns solver->ok
+        bool sweep();
+
+        uint64_t memUsed() const;
+
+        struct Stats
+        {
+            Stats() :
+                numCalls(0)
+                , numGates(0)
+                , numCands(0)
+                , numSatCalls(0)
+                , numProvedEq(0)
+                , numProvedConst(0)
+                , numRefuted(0)
+                , numUnknown(0)
+                , findTime(0)
+                , simTime(0)
+                , proveTime(0)
+                , proveTimeOut(0)
+            {}
+
+            void clear()
+            {
+                Stats tmp;
+                *this = tmp;
+            }
+
+            double totalTime() const
+            {
+                return findTime + simTime + proveTime;
+            }
+
+            Stats& operator+=(const Stats& other)
+            {
+                numCalls += other.numCalls;
+                numGates += other.numGates;
+                numCands += other.numCands;
+                numSatCalls += other.numSatCalls;
+                numProvedEq += other.numProvedEq;
+                numProvedConst += other.numProvedConst;
+                numRefuted += other.numRefuted;
+                numUnknown += other.numUnknown;
+                findTime += other.findTime;
+                simTime += other.simTime;
+                proveTime += other.proveTime;
+                proveTimeOut += other.proveTimeOut;
+
+                return *this;
+            }
+
+            void print() const
+            {
+                cout << "c -------- SWEEPING STATS --------" << endl;
+                printStatsLine("c time"
+                    , totalTime()
+                    , totalTime()/(double)numCalls
+                    , "per call"
+                );
+                printStatsLine("c gates"
+                    , numGates
+                    , (double)numGates/(double)numCalls
+                    , "per call"
+                );
+                printStatsLine("c candidates"
+                    , numCands
+                    , (double)numCands/(double)numCalls
+                    , "per call"
+                );
+                printStatsLine("c SAT calls"
+                    , numSatCalls
+                    , (double)numRefuted/(double)numSatCalls*100.0
+                    , "% refuted"
+                );
+                printStatsLine("c equivalences proved"
+                    , numProvedEq
+                );
+                printStatsLine("c constants proved"
+                    , numProvedConst
+                );
+                printStatsLine("c calls over budget"
+                    , numUnknown
+                    , (double)numUnknown/(double)numSatCalls*100.0
+                    , "% of SAT calls"
+                );
+                printStatsLine("c prove timeouts"
+                    , proveTimeOut
+                    , (double)proveTimeOut/(double)numCalls*100.0
+                    , "% of calls"
+                );
+                cout << "c -------- SWEEPING STATS END --------" << endl;
+            }
+
+            void printShort() const
+            {
+                cout
+                << "c [sweep]"
+                << " gates: " << numGates
+                << " cands: " << numCands
+                << " SAT calls: " << numSatCalls
+                << " eq: " << numProvedEq
+                << " const: " << numProvedConst
+                << " T: " << std::fixed << std::setprecision(2)
+                << findTime << " + " << simTime << " + " << proveTime
+                << " s"
+                << " T-out: " << proveTimeOut
+                << endl;
+            }
+
+            uint64_t numCalls;
+            uint64_t numGates;
+            uint64_t numCands;
+            uint64_t numSatCalls;
+            uint64_t numProvedEq;
+            uint64_t numProvedConst;
+            uint64_t numRefuted;
+            uint64_t numUnknown;
+            double findTime;
+            double simTime;
+            double proveTime;
+            uint64_t proveTimeOut;
+        };
+
+        const Stats& getStats() const;
+
+    private:
+        Solver* solver;
+
+        //out = OR(gateLits[start] ... gateLits[start+size-1])
+        struct Gate
+        {
+            Gate(const Lit _out, const uint32_t _start, const uint32_t _size) :
+                out(_out)
+                , start(_start)
+                , size(_size)
+            {}
+
+            Lit out;
+            uint32_t start;
+            uint32_t size;
+        };
+
+        //Gate extraction
+        void findGates();
+        void findGatesInClause(const Lit* lits, const uint32_t size);
+        void orderGates();
+        vector<Gate> gates;
+        vector<Lit> gateLits;
+        vector<uint32_t> gateOf; ///<Index of the gate defining the var
+        vector<Var> order; ///<Gate-defined vars in topological order
+        int64_t numMaxFind;
+
+        //Simulation
+        void simulate();
+        void buildClasses();
+        bool sameSig(const Var a, const Var b) const;
+        bool zeroSig(const Var var) const;
+        vector<uint64_t> sim; ///<simWords words per var
+        size_t simWords;
+        vector<uint32_t> topoPos;
+        vector<Var> cands; ///<Sorted by signature, then by topological position
+
+        //Proving
+        void setupProver();
+        void proveCands();
+        lbool proveEq(const Lit a, const Lit b);
+        lbool proveFalse(const Lit lit);
+        lbool solveProver();
+        bool refutedByCex(const Lit a, const Lit b) const;
+        void addCex();
+        Solver* prover;
+        vector<Lit> assumps;
+        vector<uint32_t> classOf; ///<Class of the candidate
+        vector<vector<Lit> > subReps; ///<Sub-class representatives of each class
+        vector<uint32_t> candIndex; ///<Index of the var among the candidates
+        vector<uint64_t> cexWords; ///<64 counterexamples per block, one word per candidate
+        size_t numCex;
+        int64_t numMaxProve;
+
+        //Results
+        bool applyResults();
+        vector<Lit> provedConst;
+        vector<std::pair<Lit, Lit> > provedEq;
+
+        Stats runStats;
+        Stats globalStats;
+};
+
+inline const Sweeper::Stats& Sweeper::getStats() const
+{
+    return globalStats;
+}
+
+} //end namespace
+
+#endif //__SWEEPER_H__
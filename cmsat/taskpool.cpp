@@ -0,0 +1,192 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#include "taskpool.h"
+#include "time_mem.h"
+
+using namespace CMSat;
+
+TaskPool::TaskPool(const size_t numThreads) :
+    runNum(0)
+    , workersBusy(0)
+    , quit(false)
+    , curTask(NULL)
+    , numVars(0)
+{
+    assert(numThreads >= 1);
+    for(size_t i = 0; i < numThreads; i++) {
+        queues.push_back(new WorkerQueue);
+    }
+    scratch.resize(numThreads);
+    workerCpu.resize(numThreads, 0);
+    workerSteals.resize(numThreads, 0);
+
+    //Worker 0 is the thread calling run()
+    for(size_t i = 1; i < numThreads; i++) {
+        threads.push_back(std::thread(&TaskPool::workerLoop, this, i));
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        quit = true;
+    }
+    startCond.notify_all();
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    for(size_t i = 0; i < queues.size(); i++) {
+        delete queues[i];
+    }
+}
+
+/**
+@brief The scratch buffers are resized lazily, at the start of the next run
+*/
+void TaskPool::newNumVars(const size_t _numVars)
+{
+    numVars = _numVars;
+}
+
+void TaskPool::run(const size_t numTasks, const Task& task)
+{
+    if (numTasks == 0)
+        return;
+
+    const double myTime = realTimeSec();
+    for(size_t i = 0; i < scratch.size(); i++) {
+        scratch[i].newNumVars(numVars);
+        workerCpu[i] = 0;
+        workerSteals[i] = 0;
+    }
+
+    //Deal out tasks round-robin, workers steal when they run out
+    for(size_t i = 0; i < numTasks; i++) {
+        queues[i % queues.size()]->tasks.push_back(i);
+    }
+
+    curTask = &task;
+    if (!threads.empty()) {
+        std::lock_guard<std::mutex> lock(mu);
+        workersBusy = threads.size();
+        runNum++;
+    }
+    startCond.notify_all();
+
+    const double cpuStart = cpuTime();
+    work(0);
+    workerCpu[0] = cpuTime() - cpuStart;
+
+    if (!threads.empty()) {
+        std::unique_lock<std::mutex> lock(mu);
+        while(workersBusy > 0) {
+            doneCond.wait(lock);
+        }
+    }
+    curTask = NULL;
+
+    stats.numRuns++;
+    stats.numTasks += numTasks;
+    stats.numSteals += reduce(workerSteals, (uint64_t)0, std::plus<uint64_t>());
+    stats.cpu_time += reduce(workerCpu, 0.0, std::plus<double>());
+    stats.wallTime += realTimeSec() - myTime;
+}
+
+void TaskPool::workerLoop(const size_t id)
+{
+    uint64_t lastRun = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(mu);
+            while(!quit && runNum == lastRun) {
+                startCond.wait(lock);
+            }
+            if (quit)
+                return;
+
+            lastRun = runNum;
+        }
+
+        const double cpuStart = cpuTime();
+        work(id);
+        workerCpu[id] = cpuTime() - cpuStart;
+
+        std::lock_guard<std::mutex> lock(mu);
+        workersBusy--;
+        if (workersBusy == 0) {
+            doneCond.notify_all();
+        }
+    }
+}
+
+void TaskPool::work(const size_t id)
+{
+    size_t task;
+    while(popTask(id, task)) {
+        (*curTask)(task, scratch[id]);
+    }
+}
+
+/**
+@brief Takes the last task of own queue, or steals the first of another's
+
+No tasks are added during a run, so if all queues are empty, the run is over
+for this worker
+*/
+bool TaskPool::popTask(const size_t id, size_t& task)
+{
+    {
+        WorkerQueue& q = *queues[id];
+        std::lock_guard<std::mutex> lock(q.mu);
+        if (!q.tasks.empty()) {
+            task = q.tasks.back();
+            q.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for(size_t i = 1; i < queues.size(); i++) {
+        WorkerQueue& q = *queues[(id + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(q.mu);
+        if (!q.tasks.empty()) {
+            task = q.tasks.front();
+            q.tasks.pop_front();
+            workerSteals[id]++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint64_t TaskPool::memUsed() const
+{
+    uint64_t mem = 0;
+    for(size_t i = 0; i < scratch.size(); i++) {
+        mem += scratch[i].memUsed();
+    }
+    mem += queues.size()*sizeof(WorkerQueue);
+
+    return mem;
+}
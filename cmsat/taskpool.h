@@ -0,0 +1,212 @@
+/*
+ * CryptoMiniSat
+ *
+ * Copyright (c) 2009-2013, Mate Soos and collaborators. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3.0 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+*/
+
+#ifndef __TASKPOOL_H__
+#define __TASKPOOL_H__
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "solvertypes.h"
+
+namespace CMSat {
+
+using std::vector;
+
+/**
+@brief Temporaries of one worker
+
+Same layout as PropEngine's seen/seen2/toClear. Must be cleared after use,
+just like the originals.
+*/
+struct TaskScratch
+{
+    vector<uint16_t> seen;  ///<2 * numVars elements, all zeroed out
+    vector<uint16_t> seen2; ///<2 * numVars elements, all zeroed out
+    vector<Lit>      toClear;
+
+    void newNumVars(const size_t numVars)
+    {
+        seen.resize(numVars*2, 0);
+        seen2.resize(numVars*2, 0);
+    }
+
+    uint64_t memUsed() const
+    {
+        uint64_t mem = 0;
+        mem += seen.capacity()*sizeof(uint16_t);
+        mem += seen2.capacity()*sizeof(uint16_t);
+        mem += toClear.capacity()*sizeof(Lit);
+        return mem;
+    }
+};
+
+/**
+@brief Work-stealing pool for running independent tasks of inprocessing passes
+
+The thread calling run() is worker 0, so with 1 thread everything is run
+in-line, in order. Tasks are numbered, and each task must only write its own
+result slot. Results must be combined with reduce(), which goes through them
+in task order, so the outcome does not depend on which worker ran what.
+*/
+class TaskPool
+{
+    public:
+        typedef std::function<void(const size_t task, TaskScratch& scratch)> Task;
+
+        TaskPool(const size_t numThreads);
+        ~TaskPool();
+
+        //Runs task(0)..task(numTasks-1), returns when all are done
+        void run(const size_t numTasks, const Task& task);
+
+        //Combines results in task order
+        template<class T, class Op>
+        static T reduce(const vector<T>& results, T init, Op op)
+        {
+            for(typename vector<T>::const_iterator
+                it = results.begin(), end = results.end()
+                ; it != end
+                ; it++
+            ) {
+                init = op(init, *it);
+            }
+            return init;
+        }
+
+        void newNumVars(const size_t numVars);
+        size_t getNumThreads() const;
+        uint64_t memUsed() const;
+
+        struct Stats
+        {
+            Stats() :
+                numRuns(0)
+                , numTasks(0)
+                , numSteals(0)
+                , wallTime(0)
+                , cpu_time(0)
+            {}
+
+            void clear()
+            {
+                Stats tmp;
+                *this = tmp;
+            }
+
+            Stats& operator+=(const Stats& other)
+            {
+                numRuns += other.numRuns;
+                numTasks += other.numTasks;
+                numSteals += other.numSteals;
+                wallTime += other.wallTime;
+                cpu_time += other.cpu_time;
+
+                return *this;
+            }
+
+            void print(const size_t numThreads) const
+            {
+                cout << "c -------- TASK POOL STATS --------" << endl;
+                printStatsLine("c threads"
+                    , numThreads
+                );
+
+                printStatsLine("c runs"
+                    , numRuns
+                    , (double)numTasks/(double)numRuns
+                    , "tasks per run"
+                );
+
+                printStatsLine("c steals"
+                    , numSteals
+                    , 100.0*(double)numSteals/(double)numTasks
+                    , "% of tasks"
+                );
+
+                printStatsLine("c wall time"
+                    , wallTime
+                );
+
+                printStatsLine("c CPU time (all workers)"
+                    , cpu_time
+                    , cpu_time/wallTime
+                    , "x wall time"
+                );
+                cout << "c -------- TASK POOL STATS END --------" << endl;
+            }
+
+            uint64_t numRuns;
+            uint64_t numTasks;
+            uint64_t numSteals;
+            double wallTime;
+            double cpu_time;
+        };
+        const Stats& getStats() const;
+
+    private:
+        void workerLoop(const size_t id);
+        void work(const size_t id);
+        bool popTask(const size_t id, size_t& task);
+
+        struct WorkerQueue
+        {
+            std::mutex mu;
+            std::deque<size_t> tasks;
+        };
+
+        vector<std::thread> threads;
+        vector<WorkerQueue*> queues;
+        vector<TaskScratch> scratch;
+
+        //Written only by the given worker during a run
+        vector<double> workerCpu;
+        vector<uint64_t> workerSteals;
+
+        //Start & finish of runs
+        std::mutex mu;
+        std::condition_variable startCond;
+        std::condition_variable doneCond;
+        uint64_t runNum;
+        size_t workersBusy;
+        bool quit;
+        const Task* curTask;
+
+        size_t numVars;
+        Stats stats;
+};
+
+inline size_t TaskPool::getNumThreads() const
+{
+    return queues.size();
+}
+
+inline const TaskPool::Stats& TaskPool::getStats() const
+{
+    return stats;
+}
+
+} //end namespace
+
+#endif //__TASKPOOL_H__
@@ -30,6 +30,11 @@ static inline double cpuTime(void)
 {
     return (double)clock() / CLOCKS_PER_SEC;
 }
+
+static inline double realTimeSec(void)
+{
+    return (double)clock() / CLOCKS_PER_SEC;
+}
 #else //_MSC_VER
 #include <sys/time.h>
 #include <sys/resource.h>
@@ -57,6 +62,15 @@ static inline double cpuTimeTotal(void)
 
     return (double)ru.ru_utime.tv_sec + (double)ru.ru_utime.tv_usec / 1000000.0;
 }
+
+//Wall-clock time. cpuTime() only counts the calling thread
+static inline double realTimeSec(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
 #endif //CROSS_COMPILE
 
 
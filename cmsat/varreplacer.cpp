@@ -31,7 +31,6 @@ using std::endl;
 #include "solver.h"
 #include "clausecleaner.h"
 #include "time_mem.h"
-#include "solutionextender.h"
 #include "clauseallocator.h"
 
 #ifdef VERBOSE_DEBUG
@@ -498,7 +497,7 @@ bool VarReplacer::replaceImplicit()
             #endif
 
             if (lit1 != origLit1) {
-                solver->watches[lit1.toInt()].push(*i);
+                pushWBin(solver->watches[lit1.toInt()], *i);
             } else {
                 *j++ = *i;
             }
@@ -688,49 +687,6 @@ vector<Var> VarReplacer::getReplacingVars() const
     return replacingVars;
 }
 
-/**
-@brief Used when a variable was eliminated, but it replaced some other variables
-
-This function will add to solver2 clauses that represent the relationship of
-the variables to their replaced cousins. Then, calling solver2.solve() should
-take care of everything
-*/
-void VarReplacer::extendModel(SolutionExtender* extender) const
-{
-
-    #ifdef VERBOSE_DEBUG
-    cout << "c VarReplacer::extendModel() called" << endl;
-    #endif //VERBOSE_DEBUG
-
-    vector<Lit> tmpClause;
-    uint32_t i = 0;
-    for (vector<Lit>::const_iterator
-        it = table.begin()
-        ; it != table.end()
-        ; it++, i++
-    ) {
-        //Not replaced, nothing to do
-        if (it->var() == i)
-            continue;
-
-        tmpClause.clear();
-        Lit lit1 = Lit(it->var(), true);
-        Lit lit2 = Lit(i, it->sign());
-        tmpClause.push_back(lit1);
-        tmpClause.push_back(lit2);
-        bool OK = extender->addClause(tmpClause);
-        assert(OK);
-
-        tmpClause.clear();
-        lit1 ^= true;
-        lit2 ^= true;
-        tmpClause.push_back(lit1);
-        tmpClause.push_back(lit2);
-        OK = extender->addClause(tmpClause);
-        assert(OK);
-    }
-}
-
 /**
 @brief Replaces two two vars in "ps" with one another. xorEqualFalse defines anti/equivalence
 
@@ -36,7 +36,6 @@ namespace CMSat {
 
 using std::map;
 using std::vector;
-class SolutionExtender;
 class Solver;
 
 class LaterAddBinXor
@@ -67,8 +66,6 @@ class VarReplacer
             , bool addLaterAsTwoBins
         );
 
-        void extendModel(SolutionExtender* extender) const;
-
         vector<Var> getReplacingVars() const;
         const vector<Lit>& getReplaceTable() const;
         const Lit getLitReplacedWith(Lit lit) const;
@@ -31,6 +31,7 @@
 #include "vec.h"
 
 #include <limits>
+#include <algorithm>
 
 namespace CMSat {
 
@@ -262,6 +263,8 @@ inline std::ostream& operator<<(std::ostream& os, const Watched& ws)
 
 /**
 @brief Orders the watchlists such that the order is binary, tertiary, normal, xor
+
+Binaries must always be at the front of every watchlist, see pushWBin()
 */
 struct WatchedSorter
 {
@@ -397,8 +400,58 @@ inline void removeTriAllButOne(
 
 //////////////////
 // BINARY Clause
+//
+// Binaries are always at the front of the watchlists, so loops that only need
+// binaries can stop at the first non-binary. Things that are only removed or
+// filtered keep the order, so this only needs care when adding a binary
 //////////////////
 
+/**
+@brief Adds a binary watch to the end of the binaries at the front of ws
+
+The first non-binary is moved to the end. The order of non-binaries doesn't
+matter
+*/
+static inline void pushWBin(vec<Watched>& ws, const Watched& w)
+{
+    assert(w.isBinary());
+    ws.push(w);
+
+    size_t at = 0;
+    while(ws[at].isBinary()) {
+        at++;
+    }
+    if (at + 1 < ws.size()) {
+        ws[ws.size()-1] = ws[at];
+        ws[at] = w;
+    }
+}
+
+struct WatchedIsBinary
+{
+    bool operator()(const Watched& w) const
+    {
+        return w.isBinary();
+    }
+};
+
+/**
+@brief Restores the binaries-first order after sorting ws some other way
+*/
+static inline void moveBinsToFront(vec<Watched>& ws)
+{
+    std::stable_partition(ws.begin(), ws.end(), WatchedIsBinary());
+}
+
+static inline bool binsAtFront(const vec<Watched>& ws)
+{
+    vec<Watched>::const_iterator i = ws.begin(), end = ws.end();
+    for (; i != end && i->isBinary(); i++);
+    for (; i != end && !i->isBinary(); i++);
+
+    return i == end;
+}
+
 inline bool findWBin(
     const vector<vec<Watched> >& wsFull
     , const Lit lit1
@@ -406,8 +459,8 @@ inline bool findWBin(
 ) {
     vec<Watched>::const_iterator i = wsFull[lit1.toInt()].begin();
     vec<Watched>::const_iterator end = wsFull[lit1.toInt()].end();
-    for (; i != end && (!i->isBinary() || i->lit2() != lit2); i++);
-    return i != end;
+    for (; i != end && i->isBinary() && i->lit2() != lit2; i++);
+    return i != end && i->isBinary();
 }
 
 inline bool findWBin(
@@ -418,13 +471,12 @@ inline bool findWBin(
 ) {
     vec<Watched>::const_iterator i = wsFull[lit1.toInt()].begin();
     vec<Watched>::const_iterator end = wsFull[lit1.toInt()].end();
-    for (; i != end && (
-        !i->isBinary()
-        || i->lit2() != lit2
+    for (; i != end && i->isBinary() && (
+        i->lit2() != lit2
         || i->learnt() != learnt
     ); i++);
 
-    return i != end;
+    return i != end && i->isBinary();
 }
 
 inline void removeWBin(
@@ -435,13 +487,12 @@ inline void removeWBin(
 ) {
     vec<Watched>& ws = wsFull[lit1.toInt()];
     vec<Watched>::iterator i = ws.begin(), end = ws.end();
-    for (; i != end && (
-        !i->isBinary()
-        || i->lit2() != lit2
+    for (; i != end && i->isBinary() && (
+        i->lit2() != lit2
         || i->learnt() != learnt
     ); i++);
 
-    assert(i != end);
+    assert(i != end && i->isBinary());
     vec<Watched>::iterator j = i;
     i++;
     for (; i != end; j++, i++) *j = *i;
@@ -455,8 +506,11 @@ inline Watched& findWatchedOfBin(
     , const bool learnt
 ) {
     vec<Watched>& ws = wsFull[lit1.toInt()];
-    for (vec<Watched>::iterator i = ws.begin(), end = ws.end(); i != end; i++) {
-        if (i->isBinary() && i->lit2() == lit2 && i->learnt() == learnt)
+    for (vec<Watched>::iterator i = ws.begin(), end = ws.end()
+        ; i != end && i->isBinary()
+        ; i++
+    ) {
+        if (i->lit2() == lit2 && i->learnt() == learnt)
             return *i;
     }
 
@@ -100,7 +100,6 @@ do
 		--comps 1 \
         --compsfrom $(int 0 2) \
         --compsvar $(int 20000 500000) \
-        --compslimit $(int 0 3000) \
 		instance.cnf \
 		| tee solution.out | grep -v '^v'
 
@@ -179,7 +179,6 @@ class Tester:
         cmd += "--recur %s " % random.randint(0,1)
         cmd += "--compsfrom %d " % random.randint(0,2)
         cmd += "--compsvar %d " % random.randint(20000,500000)
-        cmd += "--compslimit %d " % random.randint(0,3000)
         cmd += "--preschedsimp %s " % random.randint(0,1)
         cmd += "--implicitmanip %s " % random.randint(0,1)
 